@@ -53,6 +53,7 @@ module cache_controller(
      input mreq,
      input [3:0]wmask,
      output ce,	// clock enable for CPU
+     output miss,	// a line fill starts (performance counter)
      input [15:0]ddr_din,
      output reg[15:0]ddr_dout,
      input ddr_clk,
@@ -123,6 +124,7 @@ module cache_controller(
     wire hit = |fit;
     wire st0 = STATE == 3'b000;
     assign ce = st0 && (~mreq || hit);
+    assign miss = st0 && mreq && !hit && !r_flush;
     wire dirty = |(free & cache_dirty[index]);	
 
     wire [`WAYS-1:0]blk = flushcount[`WAYS+`SETS-1:`SETS] | {|fit[3:2], fit[3] | fit[1]};
@@ -4,7 +4,11 @@
 
 // Based on the Oberon ULX3S design
 
-module icepi_zero_top(
+module icepi_zero_top #(
+    parameter CPU_PREFETCH = 0,
+    parameter CPU_BRANCH_PREDICT = 0,
+    parameter CPU_DIV_BITS = 1
+) (
     // System clock and reset
     input  wire logic clk, // main clock input from external clock source
 
@@ -107,7 +111,10 @@ module icepi_zero_top(
 
     soc_top #(
         .FREQ_HZ(25_000_000),
-        .BAUD_RATE(1_000_000)
+        .BAUD_RATE(1_000_000),
+        .CPU_PREFETCH(CPU_PREFETCH),
+        .CPU_BRANCH_PREDICT(CPU_BRANCH_PREDICT),
+        .CPU_DIV_BITS(CPU_DIV_BITS)
     ) soc_top(
         .clk_cpu(clk_cpu),
         .clk_sdram(clk_sdram),
@@ -7,7 +7,7 @@
 // - FADD, FSUB, FMUL, FMADD, FMSUB, FNMADD, FNMSUB: IEEE754 round to zero
 // - FDIV and FSQRT do not have correct rounding
 //
-// [TODO] add FPU CSR (and instret for perf stat)]
+// [TODO] add FPU CSR
 // [TODO] FSW/FLW unaligned (does not seem to occur, but the norm requires it)
 // [TODO] correct IEEE754 round to zero for FDIV and FSQRT
 // [TODO] support IEEE754 denormals
@@ -53,6 +53,9 @@ module processor(
 
    input         interrupt_request,
 
+   input         perf_cache_miss,    // pulse: the cache starts a line fill
+   input         perf_graphite_busy, // Graphite does not accept commands
+
    input         reset      // set to 0 to reset the processor
 );
 
@@ -68,6 +71,9 @@ module processor(
 
    parameter RESET_ADDR       = 32'hF0000000;
    parameter ADDR_WIDTH       = 32;
+   parameter PREFETCH         = 0;  // fetch the next word during EXECUTE
+   parameter BRANCH_PREDICT   = 0;  // prefetch the target of jumps and loops
+   parameter DIV_BITS         = 1;  // quotient bits per cycle (1, 2 or 4)
 
    /***************************************************************************/
    // Instruction decoding.
@@ -103,6 +109,7 @@ module processor(
    wire isJAL     =  (instr[6:2] == 5'b11011); // rd <- PC+4; PC<-PC+Jimm
    wire isSYSTEM  =  (instr[6:2] == 5'b11100); // rd <- CSR <- rs1/uimm5
    wire isFPU     =  (instr[6:5] == 2'b10);    // all FPU instr except FLW/FSW
+   wire isSIMD    =  (instr[6:2] == 5'b00010); // custom-0: packed 16-bit ops
    
    wire isALU = isALUimm | isALUreg;
 
@@ -114,8 +121,10 @@ module processor(
    reg [31:0] rs2;
    reg [31:0] rs3; // this one is used by the FMA instructions.
    
-   reg [31:0] registerFile [63:0]; //  0..31: integer registers
+   reg [31:0] registerFile [63:0] /* verilator public_flat_rw */;
+                                   //  0..31: integer registers
                                    // 32..63: floating-point registers
+                                   // (accessed by the simulator)
    
    /***************************************************************************/
    // The ALU. Does operations and tests combinatorially, except divisions.
@@ -219,35 +228,166 @@ module processor(
     
    /***************************************************************************/
    // Implementation of DIV/REM instructions, highly inspired by PicoRV32
+   //
+   // Restoring division, DIV_BITS quotient bits per cycle (radix 2^DIV_BITS,
+   // DIV_BITS unrolled steps). Only the steps that can produce a non-zero
+   // quotient bit are done: for a n-bit dividend and a m-bit divisor, the
+   // quotient has at most n - m + 1 bits (32 for a division by zero). A
+   // division takes 1 + ceil((n - m + 1) / DIV_BITS) cycles, at most 33,
+   // 17 and 9 cycles for 1, 2 and 4 bits per cycle.
 
    reg [31:0] dividend;
    reg [62:0] divisor;
    reg [31:0] quotient;
    reg [5:0]  div_cnt;
    reg div_sign;
-   
+
+   // Number of significant bits
+   function [5:0] nbits32;
+      input [31:0] x;
+      integer i;
+      begin
+	 nbits32 = 0;
+	 for (i = 0; i < 32; i = i + 1)
+	   if (x[i]) nbits32 = i + 1;
+      end
+   endfunction
+
+   wire [31:0] div_abs1 = ~instr[12] & aluIn1[31] ? -aluIn1 : aluIn1;
+   wire [31:0] div_abs2 = ~instr[12] & aluIn2[31] ? -aluIn2 : aluIn2;
+   wire  [5:0] div_n1 = nbits32(div_abs1);
+   wire  [5:0] div_n2 = nbits32(div_abs2);
+
+   // Steps to do, rounded up to a multiple of DIV_BITS
+   wire  [5:0] div_steps = div_n2 == 0     ? 6'd32 :
+                           div_n1 < div_n2 ? 6'd0  : div_n1 - div_n2 + 1;
+   /* verilator lint_off WIDTH */
+   wire  [5:0] div_steps_r = (div_steps + DIV_BITS - 1) & ~(DIV_BITS - 1);
+   /* verilator lint_on WIDTH */
+
+   // DIV_BITS steps
+   reg [31:0] div_next_dividend;
+   reg [62:0] div_next_divisor;
+   reg [31:0] div_next_quotient;
+   integer    div_i;
+   always @(*) begin
+      div_next_dividend = dividend;
+      div_next_divisor  = divisor;
+      div_next_quotient = quotient;
+      for (div_i = 0; div_i < DIV_BITS; div_i = div_i + 1) begin
+	 if (div_next_divisor <= {31'b0, div_next_dividend}) begin
+	    div_next_quotient = {div_next_quotient[30:0], 1'b1};
+	    div_next_dividend = div_next_dividend - div_next_divisor[31:0];
+	 end else begin
+	    div_next_quotient = {div_next_quotient[30:0], 1'b0};
+	 end
+	 div_next_divisor = div_next_divisor >> 1;
+      end
+   end
+
    always @(posedge clk) if (ce) begin
          if (aluWr) begin
       div_sign <= ~instr[12] & (instr[13] ? aluIn1[31] : 
                                     (aluIn1[31] != aluIn2[31]) & |aluIn2);
-            dividend <=   ~instr[12] & aluIn1[31] ? -aluIn1 : aluIn1;
-            divisor  <= {(~instr[12] & aluIn2[31] ? -aluIn2 : aluIn2), 31'b0};
+            dividend <= div_abs1;
+            divisor  <= {div_abs2, 31'b0} >> (6'd32 - div_steps_r);
             quotient <= 0;
-      div_cnt <= isDivide ? 33 : 0; // one additional cycle for aluOut_div
+      // one additional cycle for aluOut_div
+      /* verilator lint_off WIDTH */
+      div_cnt <= isDivide ? div_steps_r / DIV_BITS + 1 : 0;
+      /* verilator lint_on WIDTH */
          end else begin
       if(aluBusy) div_cnt <= div_cnt - 1;
          end
          if(|div_cnt[5:1]) begin 
-            divisor <= divisor >> 1;
-      if(divisor <= {31'b0, dividend}) begin
-         quotient <= {quotient[30:0],1'b1};
-         dividend <= dividend - divisor[31:0];
-      end else begin
-         quotient <= {quotient[30:0],1'b0};	    
-      end
+            divisor  <= div_next_divisor;
+            quotient <= div_next_quotient;
+            dividend <= div_next_dividend;
          end
    end 
 
+   /***************************************************************************/
+   // Packed SIMD instructions (custom-0 opcode), on two 16-bit lanes. A
+   // subset of the RISC-V P extension, with its names and semantics but
+   // its own encoding (see src/lib/simd.h):
+   //
+   //  funct3 funct7
+   //   000   0000000  ADD16                     wrap around
+   //   000   0100000  SUB16
+   //   001   0000000  KADD16                    signed saturation
+   //   001   0100000  KSUB16
+   //   010   0000000  UKADD16                   unsigned saturation
+   //   010   0100000  UKSUB16
+   //   011   0000000  KHM16                     Q15 multiply, saturated
+   //   100   0000000  MUL16                     low 16 bits of the products
+   //   101   (R4)     KMADA  rd = rs3 + rs1.h0 * rs2.h0 + rs1.h1 * rs2.h1,
+   //                         signed, saturated to 32 bits
+   //   110   0000000  SCLIP16  rd, rs1, imm4    clip to [-2^imm4, 2^imm4 - 1]
+   //   110   0100000  UCLIP16  rd, rs1, imm4    clip to [0, 2^imm4 - 1]
+   //   111   0000000  SRLI16   rd, rs1, imm4
+   //   111   0100000  SRAI16   rd, rs1, imm4
+   //   111   1000000  SLLI16   rd, rs1, imm4
+   //
+   // The multiplications (funct3 011, 100 and 101) have their result
+   // registered, as the M extension ones, and wait one cycle.
+
+   function [15:0] sat16;  // signed saturation of a 17-bit value
+      input [16:0] x;
+      sat16 = x[16] == x[15] ? x[15:0] : {x[16], {15{~x[16]}}};
+   endfunction
+
+   function [15:0] simd_lane;
+      input [15:0] a;
+      input [15:0] b;
+      input  [2:0] funct3;
+      input  [1:0] funct7;  // instr[31:30]
+      input  [3:0] imm;     // instr[23:20]
+      reg   [16:0] sum, usum;
+      reg   [15:0] smax, smin, sra;
+      begin
+	 sum   = funct7[0] ? {a[15], a} - {b[15], b} : {a[15], a} + {b[15], b};
+	 usum  = funct7[0] ? {1'b0, a} - {1'b0, b}   : {1'b0, a} + {1'b0, b};
+	 smax  = (16'h1 << imm) - 1;
+	 smin  = ~smax;
+	 sra   = $signed(a) >>> imm;
+	 case(funct3)
+	   3'b000: simd_lane = sum[15:0];
+	   3'b001: simd_lane = sat16(sum);
+	   3'b010: simd_lane = !usum[16] ? usum[15:0] :
+			       funct7[0] ? 16'h0000 : 16'hFFFF;
+	   3'b110: simd_lane = funct7[0] ?
+			       (a[15] ? 16'h0000 : a > smax ? smax : a) :
+			       ($signed(a) < $signed(smin) ? smin :
+				$signed(a) > $signed(smax) ? smax : a);
+	   default: simd_lane = funct7[1] ? a << imm :
+				funct7[0] ? sra : a >> imm;
+	 endcase
+      end
+   endfunction
+
+   wire [31:0] simdOut_base = {
+      simd_lane(rs1[31:16], rs2[31:16], instr[14:12], instr[31:30], instr[23:20]),
+      simd_lane(rs1[15: 0], rs2[15: 0], instr[14:12], instr[31:30], instr[23:20])
+   };
+
+   wire signed [31:0] simd_p0 = $signed(rs1[15: 0]) * $signed(rs2[15: 0]);
+   wire signed [31:0] simd_p1 = $signed(rs1[31:16]) * $signed(rs2[31:16]);
+   wire signed [33:0] simd_mac = $signed(rs3) + simd_p0 + simd_p1;
+
+   reg [31:0] simdOut_mul;
+   always @(posedge clk) if (ce) begin
+      (* parallel_case *)
+      case(1'b1)
+	funct3Is[3]: simdOut_mul <= {sat16(simd_p1[31:15]), sat16(simd_p0[31:15])};
+	funct3Is[4]: simdOut_mul <= {simd_p1[15:0], simd_p0[15:0]};
+	default:     simdOut_mul <= simd_mac[33:31] == 3'b000 || simd_mac[33:31] == 3'b111 ?
+				      simd_mac[31:0] : {simd_mac[33], {31{~simd_mac[33]}}};
+      endcase
+   end
+
+   wire simdWait = isSIMD & (funct3Is[3] | funct3Is[4] | funct3Is[5]);
+   wire [31:0] simdOut = simdWait ? simdOut_mul : simdOut_base;
+
    /***************************************************************************/
    // The predicate for conditional branches.
 
@@ -267,7 +407,8 @@ module processor(
       // Fetch registers as soon as instruction is ready.
       rs1 <= registerFile[{raw_rs1IsFP,raw_instr[19:15]}]; 
       rs2 <= registerFile[{raw_rs2IsFP,raw_instr[24:20]}];
-      rs3 <= registerFile[{1'b1,       raw_instr[31:27]}];
+      // rs3 is an integer register for KMADA (custom-0)
+      rs3 <= registerFile[{raw_instr[6:2] != 5'b00010, raw_instr[31:27]}];
          end else if(state[DECOMPRESS_GETREGS_bit]) begin
       // For compressed instructions, fetch registers once decompressed.
       rs1 <= registerFile[{decomp_rs1IsFP,instr[19:15]}];
@@ -342,7 +483,7 @@ module processor(
    // Program counter and branch target computation.
    /***************************************************************************/
 
-   reg  [ADDR_WIDTH-1:0] PC; // The program counter.
+   reg  [ADDR_WIDTH-1:0] PC /* verilator public_flat_rw */; // The program counter.
    reg  [31:2] instr;        // Latched instruction. Note that bits 0 and 1 are
                              // ignored (not used in RV32I base instr set).
 
@@ -366,6 +507,7 @@ module processor(
    assign mem_addr =   state[WAIT_INSTR_bit] | state[FETCH_INSTR_bit] ?
                        fetch_second_half ? {PCplus4[ADDR_WIDTH-1:2], 2'b00}
                                          : {PC     [ADDR_WIDTH-1:2], 2'b00}
+                     : prefetch          ? {prefetch_addr,           2'b00}
                        : loadstore_addr  ;
    /* verilator lint_on WIDTH */
 
@@ -397,16 +539,45 @@ module processor(
    reg  [ADDR_WIDTH-1:0] mtvec;   // The address of the interrupt handler.
    reg                   mstatus; // Interrupt enable
    reg                   mcause;  // Interrupt cause (and lock)
-   reg  [63:0]           cycles;  // Cycle counter
+   reg  [63:0]           cycles /* verilator public_flat_rw */;  // Cycle counter
 
    always @(posedge clk) if (ce) cycles <= cycles + 1;
 
+   // Performance counters (read-only, see src/lib/perf.h). They count on
+   // every clk, so that the cycles spent with ce low are accounted for.
+   reg  [63:0]           instret /* verilator public_flat_rw */; // Retired instructions
+   reg  [63:0]           hpm_cache_miss;    // mhpmcounter3: cache line fills
+   reg  [63:0]           hpm_stall;         // mhpmcounter4: cycles with ce low
+   reg  [63:0]           hpm_fpu_busy;      // mhpmcounter5: FPU busy cycles
+   reg  [63:0]           hpm_div_busy;      // mhpmcounter6: divider busy cycles
+   reg  [63:0]           hpm_graphite_busy; // mhpmcounter7: Graphite back-pressure
+
+   always @(posedge clk) begin
+      if (ce & state[EXECUTE_bit] & !interrupt) instret <= instret + 1;
+      if (perf_cache_miss)    hpm_cache_miss    <= hpm_cache_miss + 1;
+      if (!ce)                hpm_stall         <= hpm_stall + 1;
+      if (ce & fpuBusy)       hpm_fpu_busy      <= hpm_fpu_busy + 1;
+      if (ce & aluBusy)       hpm_div_busy      <= hpm_div_busy + 1;
+      if (perf_graphite_busy) hpm_graphite_busy <= hpm_graphite_busy + 1;
+   end
+
    wire sel_mstatus = (instr[31:20] == 12'h300);
    wire sel_mtvec   = (instr[31:20] == 12'h305);
    wire sel_mepc    = (instr[31:20] == 12'h341);
    wire sel_mcause  = (instr[31:20] == 12'h342);
-   wire sel_cycles  = (instr[31:20] == 12'hC00);
-   wire sel_cyclesh = (instr[31:20] == 12'hC80);
+
+   // Counters: cycle, instret and hpmcounter3..7 at 0xC00 + n (user) and
+   // 0xB00 + n (machine), their upper halves at + 0x80.
+   wire sel_counter = ((instr[31:28] == 4'hC) | (instr[31:28] == 4'hB)) &
+                      (instr[26:25] == 2'b00);
+   wire [63:0] counter =
+     (instr[24:20] == 5'd0 ? cycles            : 64'b0) |
+     (instr[24:20] == 5'd2 ? instret           : 64'b0) |
+     (instr[24:20] == 5'd3 ? hpm_cache_miss    : 64'b0) |
+     (instr[24:20] == 5'd4 ? hpm_stall         : 64'b0) |
+     (instr[24:20] == 5'd5 ? hpm_fpu_busy      : 64'b0) |
+     (instr[24:20] == 5'd6 ? hpm_div_busy      : 64'b0) |
+     (instr[24:20] == 5'd7 ? hpm_graphite_busy : 64'b0) ;
 
    // Read CSRs
    /* verilator lint_off WIDTH */   
@@ -415,8 +586,7 @@ module processor(
      (sel_mtvec   ? mtvec                  : 32'b0) |
      (sel_mepc    ? mepc                   : 32'b0) |
      (sel_mcause  ? {mcause, 31'b0}        : 32'b0) |
-     (sel_cycles  ? cycles[31:0]           : 32'b0) |
-     (sel_cyclesh ? cycles[63:32]          : 32'b0) ;
+     (sel_counter ? (instr[27] ? counter[63:32] : counter[31:0]) : 32'b0) ;
    /* verilator lint_on WIDTH */
 
    // Write CSRs: 5 bit unsigned immediate or content of RS1
@@ -447,6 +617,7 @@ module processor(
       (isSYSTEM            ? CSR_read  : 32'b0) |  // SYSTEM
       (isLUI               ? Uimm      : 32'b0) |  // LUI
       (isALU               ? aluOut    : 32'b0) |  // ALUreg, ALUimm
+      (isSIMD              ? simdOut   : 32'b0) |  // custom-0
       (isFPU               ? fpuOut    : 32'b0) |  // FPU
       (isAUIPC             ? PCplusImm : 32'b0) |  // AUIPC
       (isJALR   | isJAL    ? PCinc     : 32'b0) |  // JAL, JALR
@@ -523,6 +694,25 @@ module processor(
    wire current_unaligned_long = &cached_mem [17:16] & PC    [1];
    wire    next_unaligned_long = &cached_data[17:16] & PC_new[1];
 
+   // Prefetch: when the instruction being executed does not use the memory,
+   // the word that follows the cached one is read during EXECUTE. If it is
+   // the next word to fetch (sequential code or second half of an unaligned
+   // long instruction), its data is there in WAIT_INSTR and FETCH_INSTR is
+   // skipped.
+   //
+   // With BRANCH_PREDICT, JAL and the backward branches (loops) are
+   // predicted taken (static BTFN prediction): the word of their target
+   // is prefetched instead. PCplusImm only depends on registers, unlike
+   // PC_new that waits for the branch predicate and the JALR adder.
+   wire predict_taken = BRANCH_PREDICT & (isJAL | (isBranch & instr[31]));
+   wire [ADDR_WIDTH-1:2] prefetch_addr = predict_taken ? PCplusImm[ADDR_WIDTH-1:2]
+                                                       : cached_addr + 1;
+   wire prefetch = PREFETCH & state[EXECUTE_bit] & ~isLoad & ~isStore &
+                   ~isFPU & ~(isALUreg & funcM) & ~simdWait;
+   wire next_prefetched = prefetch &
+                          (next_cache_hit ? ~predict_taken  // second half
+                                          : PC_new[ADDR_WIDTH-1:2] == prefetch_addr);
+
    reg fetch_second_half;
    reg long_instr;
 
@@ -566,7 +756,7 @@ module processor(
    );
 
    // The memory-read signal.
-   assign mem_rstrb = state[EXECUTE_bit] & isLoad | state[FETCH_INSTR_bit];
+   assign mem_rstrb = state[EXECUTE_bit] & isLoad | state[FETCH_INSTR_bit] | prefetch;
 
    // The mask for memory-write.
    assign mem_wmask = {4{state[EXECUTE_bit] & isStore}} & STORE_wmask;
@@ -580,12 +770,14 @@ module processor(
    wire needToWait = isLoad | 
                     (isStore & `NRV_IS_IO_ADDR(mem_addr)) | 
                      isALUreg & funcM  /* isDivide */ | 
-                     isFPU;  
+                     isFPU   | 
+                     simdWait;
 `else
    wire needToWait = isLoad  | 
                      isStore | 
                      isALUreg & funcM  /* isDivide */ | 
-                     isFPU;  
+                     isFPU   | 
+                     simdWait;
 `endif
 
    wire [ADDR_WIDTH-1:0] PC_new = 
@@ -658,7 +850,8 @@ module processor(
 
 		 state <= next_cache_hit & ~next_unaligned_long
   		        ? (needToWait ? WAIT_ALU_OR_MEM_SKIP : WAIT_INSTR)
-			: (needToWait ? WAIT_ALU_OR_MEM      : FETCH_INSTR);
+			: (needToWait ? WAIT_ALU_OR_MEM      :
+			   next_prefetched ? WAIT_INSTR      : FETCH_INSTR);
 
 		 fetch_second_half <= next_cache_hit & next_unaligned_long;
               end
@@ -686,6 +879,12 @@ module processor(
 `ifdef BENCH
    initial begin
       cycles = 0;
+      instret = 0;
+      hpm_cache_miss = 0;
+      hpm_stall = 0;
+      hpm_fpu_busy = 0;
+      hpm_div_busy = 0;
+      hpm_graphite_busy = 0;
       registerFile[0] = 0;
    end
 `endif
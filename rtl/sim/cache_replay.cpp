@@ -0,0 +1,243 @@
+// cache_replay.cpp
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// Replays a memory request trace of the simulator (--cache-trace) against
+// cache models of various geometries and reports their miss rate and SDRAM
+// traffic. The models behave as cache_controller.v: set associative, LRU,
+// write-back with allocation on write misses, and a flush writing the dirty
+// lines back without invalidating them.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "cache_trace.h"
+
+// Geometry of cache_controller.v: 2^SETS sets of 2^WAYS ways of 256 bytes
+#define RTL_SETS 16
+#define RTL_WAYS 4
+#define RTL_LINE 256
+
+struct config_t {
+    int sets;
+    int ways;
+    int line;                   // bytes
+};
+
+struct stats_t {
+    uint64_t accesses[2];       // CPU, Graphite
+    uint64_t misses[2];
+    uint64_t writebacks;        // dirty lines evicted
+    uint64_t flush_writebacks;  // dirty lines written back by a flush
+};
+
+struct way_t {
+    uint32_t tag;               // line address
+    bool valid;
+    bool dirty;
+    uint64_t used;              // last access, for LRU
+};
+
+static bool is_pow2(int n)
+{
+    return n > 0 && !(n & (n - 1));
+}
+
+static int log2i(int n)
+{
+    int l = 0;
+    while ((1 << l) < n)
+        ++l;
+    return l;
+}
+
+static stats_t replay(const config_t &cfg, const std::vector<uint32_t> &records)
+{
+    stats_t s;
+    memset(&s, 0, sizeof(s));
+    std::vector<way_t> cache((size_t)cfg.sets * cfg.ways, way_t{0, false, false, 0});
+    int line_bits = log2i(cfg.line);
+    uint32_t set_mask = cfg.sets - 1;
+    uint64_t now = 0;
+
+    for (uint32_t r : records) {
+        if (r & CACHE_TRACE_FLUSH) {
+            for (way_t &w : cache) {
+                if (w.dirty)
+                    s.flush_writebacks++;
+                w.dirty = false;
+            }
+            continue;
+        }
+
+        int src = (r & CACHE_TRACE_GRAPHITE) ? 1 : 0;
+        bool write = (r >> CACHE_TRACE_WMASK_SHIFT) & CACHE_TRACE_WMASK_MASK;
+        uint32_t line_addr = ((r & CACHE_TRACE_ADDR_MASK) << 2) >> line_bits;
+        way_t *set = &cache[(size_t)(line_addr & set_mask) * cfg.ways];
+        s.accesses[src]++;
+        now++;
+
+        way_t *w = nullptr;
+        for (int i = 0; i < cfg.ways; ++i) {
+            if (set[i].valid && set[i].tag == line_addr) {
+                w = &set[i];
+                break;
+            }
+        }
+        if (!w) {
+            // Miss: the least recently used way is replaced (invalid ones first)
+            s.misses[src]++;
+            w = &set[0];
+            for (int i = 1; i < cfg.ways && w->valid; ++i) {
+                if (!set[i].valid || set[i].used < w->used)
+                    w = &set[i];
+            }
+            if (w->dirty)
+                s.writebacks++;
+            w->tag = line_addr;
+            w->valid = true;
+            w->dirty = false;
+        }
+        w->used = now;
+        w->dirty |= write;
+    }
+
+    return s;
+}
+
+static bool parse_config(const char *str, config_t *cfg)
+{
+    if (sscanf(str, "%dx%dx%d", &cfg->sets, &cfg->ways, &cfg->line) != 3)
+        return false;
+    return is_pow2(cfg->sets) && cfg->ways > 0 && is_pow2(cfg->line) && cfg->line >= 4;
+}
+
+static bool load_trace(const char *path, std::vector<uint32_t> *records)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+
+    char magic[CACHE_TRACE_MAGIC_SIZE];
+    if (fread(magic, 1, sizeof(magic), f) != sizeof(magic) || memcmp(magic, CACHE_TRACE_MAGIC, sizeof(magic))) {
+        fprintf(stderr, "%s: not a cache trace\n", path);
+        fclose(f);
+        return false;
+    }
+
+    uint8_t buf[65536];
+    size_t n;
+    while ((n = fread(buf, 1, sizeof(buf), f)) >= 4) {
+        for (size_t i = 0; i + 4 <= n; i += 4)
+            records->push_back(buf[i] | buf[i + 1] << 8 | buf[i + 2] << 16 | (uint32_t)buf[i + 3] << 24);
+    }
+    fclose(f);
+    return true;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr, "Usage: %s [options] <trace>\n"
+                    "  --config <sets>x<ways>x<line> cache geometry to replay, may be repeated\n"
+                    "                      (default: 8, 16 and 32 KiB, 1 to 8 ways, 64 to 256-byte lines)\n"
+                    "  --csv               print the results as CSV\n",
+            name);
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<config_t> configs;
+    const char *path = nullptr;
+    bool csv = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--config") && i + 1 < argc) {
+            config_t cfg;
+            if (!parse_config(argv[++i], &cfg)) {
+                fprintf(stderr, "%s: invalid geometry\n", argv[i]);
+                return 1;
+            }
+            configs.push_back(cfg);
+        } else if (!strcmp(argv[i], "--csv")) {
+            csv = true;
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!path) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (configs.empty()) {
+        for (int size = 8192; size <= 32768; size *= 2)
+            for (int line = 64; line <= 256; line *= 2)
+                for (int ways = 1; ways <= 8; ways *= 2)
+                    configs.push_back(config_t{size / (line * ways), ways, line});
+    }
+
+    std::vector<uint32_t> records;
+    if (!load_trace(path, &records))
+        return 1;
+
+    uint64_t nb_flushes = 0, nb_writes = 0, nb_graphite = 0;
+    for (uint32_t r : records) {
+        if (r & CACHE_TRACE_FLUSH) {
+            nb_flushes++;
+            continue;
+        }
+        if ((r >> CACHE_TRACE_WMASK_SHIFT) & CACHE_TRACE_WMASK_MASK)
+            nb_writes++;
+        if (r & CACHE_TRACE_GRAPHITE)
+            nb_graphite++;
+    }
+
+    if (csv) {
+        printf("sets,ways,line,size,accesses,misses,miss_rate,cpu_misses,graphite_misses,writebacks,flush_writebacks,sdram_bytes\n");
+    } else {
+        printf("%s: %zu requests (%llu writes, %llu from Graphite), %llu flushes\n", path,
+               (size_t)(records.size() - nb_flushes), (unsigned long long)nb_writes,
+               (unsigned long long)nb_graphite, (unsigned long long)nb_flushes);
+        printf("  %-14s %8s %10s %10s %10s %10s %12s %12s\n", "geometry", "size", "miss rate",
+               "misses", "cpu", "graphite", "write-backs", "SDRAM MiB");
+    }
+
+    for (const config_t &cfg : configs) {
+        stats_t s = replay(cfg, records);
+        uint64_t accesses = s.accesses[0] + s.accesses[1];
+        uint64_t misses = s.misses[0] + s.misses[1];
+        uint64_t writebacks = s.writebacks + s.flush_writebacks;
+        // Each miss reads a line, each write-back writes one
+        uint64_t sdram_bytes = (misses + writebacks) * (uint64_t)cfg.line;
+        double miss_rate = accesses ? (double)misses / accesses : 0.0;
+        int size = cfg.sets * cfg.ways * cfg.line;
+
+        if (csv) {
+            printf("%d,%d,%d,%d,%llu,%llu,%.6f,%llu,%llu,%llu,%llu,%llu\n", cfg.sets, cfg.ways, cfg.line, size,
+                   (unsigned long long)accesses, (unsigned long long)misses, miss_rate,
+                   (unsigned long long)s.misses[0], (unsigned long long)s.misses[1],
+                   (unsigned long long)s.writebacks, (unsigned long long)s.flush_writebacks,
+                   (unsigned long long)sdram_bytes);
+        } else {
+            bool rtl = cfg.sets == RTL_SETS && cfg.ways == RTL_WAYS && cfg.line == RTL_LINE;
+            std::string geometry = std::to_string(cfg.sets) + "x" + std::to_string(cfg.ways) + "x" + std::to_string(cfg.line);
+            printf("%c %-14s %5d KiB %9.3f%% %10llu %10llu %10llu %12llu %12.1f\n", rtl ? '*' : ' ',
+                   geometry.c_str(), size / 1024, 100.0 * miss_rate, (unsigned long long)misses,
+                   (unsigned long long)s.misses[0], (unsigned long long)s.misses[1],
+                   (unsigned long long)writebacks, sdram_bytes / (1024.0 * 1024.0));
+        }
+    }
+
+    if (!csv)
+        printf("* geometry of cache_controller.v (%dx%dx%d)\n", RTL_SETS, RTL_WAYS, RTL_LINE);
+
+    return 0;
+}
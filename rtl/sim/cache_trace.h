@@ -0,0 +1,35 @@
+// cache_trace.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// Memory request trace of the cache controller, written by the simulator
+// (--cache-trace) and replayed by cache_replay.
+//
+// The file starts with the 8-byte magic and is followed by one 32-bit
+// little-endian record per request served by the cache: the word address
+// (cache_ctrl_adr[25:2]), the byte write mask (0 for a read) and the
+// requester. Consecutive reads of the same word by the same requester are
+// recorded once. A flush of the cache is a record of its own.
+
+#ifndef CACHE_TRACE_H
+#define CACHE_TRACE_H
+
+#include <stdint.h>
+
+#define CACHE_TRACE_MAGIC       "XGCTRC01"
+#define CACHE_TRACE_MAGIC_SIZE  8
+
+#define CACHE_TRACE_ADDR_MASK   0x00FFFFFFu     // word address
+#define CACHE_TRACE_WMASK_SHIFT 24
+#define CACHE_TRACE_WMASK_MASK  0xFu
+#define CACHE_TRACE_GRAPHITE    (1u << 28)      // request from Graphite, CPU otherwise
+#define CACHE_TRACE_FLUSH       (1u << 31)      // flush, no request
+
+static inline uint32_t cache_trace_record(uint32_t byte_addr, uint32_t wmask, bool graphite)
+{
+    return ((byte_addr >> 2) & CACHE_TRACE_ADDR_MASK) |
+           ((wmask & CACHE_TRACE_WMASK_MASK) << CACHE_TRACE_WMASK_SHIFT) |
+           (graphite ? CACHE_TRACE_GRAPHITE : 0);
+}
+
+#endif  // CACHE_TRACE_H
@@ -0,0 +1,40 @@
+// ps2_sim_fifo.sv
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// Receive FIFO of the PS/2 keyboard and mouse, fed directly by the simulator
+// (one code or mouse word per strobe) in place of ps2kbd/ps2mouse.
+
+module ps2_sim_fifo #(
+    parameter data_width = 8
+) (
+    input  wire logic                  clk,
+    input  wire logic                  rst,     // active low
+    input  wire logic [data_width-1:0] data_i,
+    input  wire logic                  strobe_i,
+    input  wire logic                  done,    // "data has been read"
+    output      logic                  rdy,     // "data is available"
+    output      logic [data_width-1:0] data
+);
+
+    logic [data_width-1:0] fifo[15:0];  // 16 entries, as ps2kbd
+    logic [3:0] inptr, outptr;
+
+    assign data = fifo[outptr];
+    assign rdy = inptr != outptr;
+
+    always_ff @(posedge clk) begin
+        if (!rst) begin
+            inptr <= 4'd0;
+            outptr <= 4'd0;
+        end else begin
+            if (strobe_i) begin
+                fifo[inptr] <= data_i;
+                inptr <= inptr + 4'd1;
+            end
+            if (rdy && done)
+                outptr <= outptr + 4'd1;
+        end
+    end
+
+endmodule
@@ -0,0 +1,69 @@
+// sdram_tlm.cpp
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+#include "sdram_tlm.h"
+#include "sim_rtl.h"
+
+#include <cassert>
+#include <cstring>
+
+void sdram_tlm_reset(sdram_tlm_t *s)
+{
+    memset(s, 0, sizeof(*s));
+}
+
+static void end_burst(sdram_tlm_t *s, Vtop *top)
+{
+    top->sdram_tlm_cmd_ack_i = 0;
+    s->cmd = 0;
+    s->turnaround = SDRAM_TLM_TURNAROUND;
+}
+
+void sdram_tlm_negedge(sdram_tlm_t *s, uint16_t *mem, Vtop *top)
+{
+    if (!s->cmd) {
+        if (s->turnaround > 0) {
+            s->turnaround--;
+            return;
+        }
+        if (!top->sdram_tlm_cmd_o)
+            return;
+
+        // Accept the command. The data phase starts on the next cycle, once
+        // the SoC has seen the acknowledge and routed the data (crw).
+        s->cmd = top->sdram_tlm_cmd_o;
+        s->len = s->cmd == CMD_READ_32 ? 16 : 128;
+        s->addr = top->sdram_tlm_addr_o << 1;   // sys_ADDR is in units of 2 words
+        s->phase = 0;
+        assert(s->addr + s->len <= 8192 * 512 * 4);
+
+        if (s->cmd != CMD_WRITE_256)
+            memcpy(s->burst, &mem[s->addr], s->len * sizeof(uint16_t));
+
+        top->sdram_tlm_cmd_ack_i = s->cmd;
+        return;
+    }
+
+    int k = s->phase++;
+
+    if (s->cmd == CMD_WRITE_256) {
+        // The cache controller presents word n on sys_DIN two cycles after
+        // the write data valid strobe has been sampled for it.
+        top->sdram_tlm_wr_data_valid_i = k < s->len;
+        if (k >= 2)
+            s->burst[k - 2] = top->sdram_tlm_din_o;
+        if (k == s->len + 1) {
+            memcpy(&mem[s->addr], s->burst, s->len * sizeof(uint16_t));
+            end_burst(s, top);
+        }
+    } else {
+        if (k < s->len) {
+            top->sdram_tlm_rd_data_valid_i = 1;
+            top->sdram_tlm_dout_i = s->burst[k];
+        } else {
+            top->sdram_tlm_rd_data_valid_i = 0;
+            end_burst(s, top);
+        }
+    }
+}
@@ -0,0 +1,34 @@
+// sdram_tlm.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// Transaction-level SDRAM model. Replaces the SDRAM controller (sdram.v)
+// and serves the sys_CMD bursts directly from the simulator memory array.
+
+#ifndef SDRAM_TLM_H
+#define SDRAM_TLM_H
+
+#include <stdint.h>
+
+#include "Vtop.h"
+
+#define SDRAM_TLM_MAX_BURST_LEN 128 // 16-bit words
+
+// Idle cycles between two bursts (burst stop/precharge in the real controller)
+#define SDRAM_TLM_TURNAROUND    2
+
+struct sdram_tlm_t {
+    uint8_t  cmd;           // command being served, 0 when idle
+    uint32_t addr;          // 16-bit word address of the burst
+    int      len;           // burst length in 16-bit words
+    int      phase;         // cycles elapsed in the data phase
+    int      turnaround;    // idle cycles left before the next command
+    uint16_t burst[SDRAM_TLM_MAX_BURST_LEN];
+};
+
+void sdram_tlm_reset(sdram_tlm_t *s);
+
+// To be called on each negative edge of clk_sdram
+void sdram_tlm_negedge(sdram_tlm_t *s, uint16_t *mem, Vtop *top);
+
+#endif  // SDRAM_TLM_H
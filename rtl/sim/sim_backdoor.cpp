@@ -0,0 +1,216 @@
+// sim_backdoor.cpp
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+#include "sim_backdoor.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+bool sim_backdoor_open(sim_backdoor_t *b, const char *path, uint16_t *mem, size_t size)
+{
+    *b = sim_backdoor_t();
+    b->listen_fd = -1;
+    b->fd = -1;
+    b->mem = (uint8_t *)mem;
+    b->size = size;
+
+    if (!path)
+        return true;
+
+    struct sockaddr_un sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(sa.sun_path)) {
+        fprintf(stderr, "%s: socket path too long\n", path);
+        return false;
+    }
+    strcpy(sa.sun_path, path);
+    b->path = path;
+
+    unlink(path);
+    b->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (b->listen_fd < 0 || bind(b->listen_fd, (struct sockaddr *)&sa, sizeof(sa)) < 0 ||
+        listen(b->listen_fd, 1) < 0) {
+        perror(path);
+        if (b->listen_fd >= 0)
+            close(b->listen_fd);
+        b->listen_fd = -1;
+        return false;
+    }
+
+    printf("Memory backdoor on %s\n", path);
+    return true;
+}
+
+static void disconnect(sim_backdoor_t *b)
+{
+    close(b->fd);
+    b->fd = -1;
+    b->rx.clear();
+    b->watches.clear();
+    b->paused = false;
+}
+
+static bool send_all(sim_backdoor_t *b, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    while (len > 0) {
+        ssize_t n = send(b->fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            disconnect(b);
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool reply(sim_backdoor_t *b, uint32_t cmd, uint32_t addr, uint32_t len, uint32_t arg)
+{
+    sim_backdoor_msg_t msg = {cmd, addr, len, arg};
+    return send_all(b, &msg, sizeof(msg));
+}
+
+static bool in_range(sim_backdoor_t *b, const sim_backdoor_msg_t &msg)
+{
+    return msg.addr <= b->size && msg.len <= b->size - msg.addr;
+}
+
+// Returns the number of bytes consumed from rx, 0 if the request is incomplete
+static size_t serve(sim_backdoor_t *b, uint64_t cycles)
+{
+    if (b->rx.size() < sizeof(sim_backdoor_msg_t))
+        return 0;
+    sim_backdoor_msg_t msg;
+    memcpy(&msg, b->rx.data(), sizeof(msg));
+
+    switch (msg.cmd) {
+        case 'R':
+            if (!in_range(b, msg))
+                break;
+            // Sent directly from the memory array
+            if (reply(b, 'R', msg.addr, msg.len, 0))
+                send_all(b, b->mem + msg.addr, msg.len);
+            return sizeof(msg);
+
+        case 'W':
+            if (!in_range(b, msg))
+                break;
+            if (b->rx.size() < sizeof(msg) + msg.len)
+                return 0;
+            memcpy(b->mem + msg.addr, b->rx.data() + sizeof(msg), msg.len);
+            reply(b, 'W', msg.addr, msg.len, 0);
+            return sizeof(msg) + msg.len;
+
+        case 'A':
+            if (!in_range(b, msg) || !msg.len)
+                break;
+            b->watches.push_back({msg.addr, msg.len, (msg.arg & 1) != 0});
+            reply(b, 'A', msg.addr, msg.len, 0);
+            return sizeof(msg);
+
+        case 'D':
+            b->watches.erase(std::remove_if(b->watches.begin(), b->watches.end(),
+                [&](const sim_backdoor_watch_t &w) { return w.addr == msg.addr && w.len == msg.len; }),
+                b->watches.end());
+            reply(b, 'D', msg.addr, msg.len, 0);
+            return sizeof(msg);
+
+        case 'C':
+            b->paused = false;
+            reply(b, 'C', 0, 0, 0);
+            return sizeof(msg);
+
+        case 'S':
+            if (reply(b, 'S', 0, sizeof(cycles), b->paused))
+                send_all(b, &cycles, sizeof(cycles));
+            return sizeof(msg);
+    }
+
+    // Invalid command or range: the data of a write is not consumed, the
+    // client is expected to disconnect
+    reply(b, 'X', msg.addr, msg.len, msg.cmd);
+    return sizeof(msg);
+}
+
+void sim_backdoor_posedge(sim_backdoor_t *b, uint64_t cycles, Vtop *top)
+{
+    if (b->watches.empty() || !top->cpu_store_o)
+        return;
+
+    uint32_t addr = top->cpu_addr_o & ~3u;
+    uint32_t mask = top->cpu_wmask_o;
+    for (const sim_backdoor_watch_t &w : b->watches) {
+        bool hit = false;
+        for (uint32_t i = 0; i < 4; ++i)
+            if ((mask >> i) & 1 && addr + i >= w.addr && addr + i - w.addr < w.len)
+                hit = true;
+        if (!hit)
+            continue;
+
+        uint8_t payload[12];
+        uint32_t data = top->cpu_wdata_o;
+        memcpy(payload, &data, sizeof(data));
+        memcpy(payload + 4, &cycles, sizeof(cycles));
+        if (reply(b, 'E', addr, sizeof(payload), mask) && send_all(b, payload, sizeof(payload)) && w.stop)
+            b->paused = true;
+        break;
+    }
+}
+
+void sim_backdoor_poll(sim_backdoor_t *b, uint64_t cycles, int timeout_ms)
+{
+    if (b->listen_fd < 0)
+        return;
+
+    if (b->fd < 0) {
+        struct pollfd pfd = {b->listen_fd, POLLIN, 0};
+        if (poll(&pfd, 1, timeout_ms) <= 0)
+            return;
+        b->fd = accept(b->listen_fd, nullptr, nullptr);
+        if (b->fd < 0)
+            return;
+        timeout_ms = 0;
+    }
+
+    struct pollfd pfd = {b->fd, POLLIN, 0};
+    while (b->fd >= 0 && poll(&pfd, 1, timeout_ms) > 0) {
+        uint8_t buf[65536];
+        ssize_t n = recv(b->fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            disconnect(b);
+            return;
+        }
+        b->rx.insert(b->rx.end(), buf, buf + n);
+
+        size_t consumed;
+        while (b->fd >= 0 && (consumed = serve(b, cycles)) > 0)
+            b->rx.erase(b->rx.begin(), b->rx.begin() + consumed);
+
+        // Drain what is already there, then return
+        timeout_ms = 0;
+    }
+}
+
+void sim_backdoor_close(sim_backdoor_t *b)
+{
+    if (b->fd >= 0)
+        close(b->fd);
+    if (b->listen_fd >= 0) {
+        close(b->listen_fd);
+        unlink(b->path.c_str());
+    }
+    b->fd = -1;
+    b->listen_fd = -1;
+}
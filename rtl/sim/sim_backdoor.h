@@ -0,0 +1,76 @@
+// sim_backdoor.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// Memory backdoor. A client connected to a Unix socket reads and writes the
+// simulator memory array directly and is notified of the CPU stores to
+// watched ranges, optionally pausing the simulation until it resumes it.
+//
+// Every message starts with a sim_backdoor_msg_t (host byte order):
+//
+//   'R' addr len          read:   reply 'R' addr len + <len> bytes
+//   'W' addr len + data   write:  reply 'W' addr len
+//   'A' addr len stop     watch the stores to [addr, addr + len), pausing
+//                         if stop is 1: reply 'A' addr len
+//   'D' addr len          remove the watch: reply 'D' addr len
+//   'C'                   resume a paused simulation: reply 'C'
+//   'S'                   status: reply 'S' 0 8 paused + cycles (uint64_t)
+//
+// Events: 'E' addr 12 wmask + data (uint32_t) + cycle (uint64_t).
+// Errors: 'X' addr len <command>.
+//
+// The CPU stores go through the write-back cache: the memory array holds the
+// stored data once the cache lines are written back (flush through the CONFIG
+// register), and written ranges must not be cached by the CPU.
+
+#ifndef SIM_BACKDOOR_H
+#define SIM_BACKDOOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "Vtop.h"
+
+struct sim_backdoor_msg_t {
+    uint32_t cmd;
+    uint32_t addr;              // byte address
+    uint32_t len;               // bytes
+    uint32_t arg;
+};
+
+struct sim_backdoor_watch_t {
+    uint32_t addr;
+    uint32_t len;
+    bool stop;
+};
+
+struct sim_backdoor_t {
+    std::string path;
+    int listen_fd;
+    int fd;                     // client, -1 if none
+    std::vector<uint8_t> rx;    // partial request
+
+    uint8_t *mem;
+    size_t size;
+
+    std::vector<sim_backdoor_watch_t> watches;
+    bool paused;
+};
+
+// path may be nullptr for no backdoor. Returns false if the socket cannot be
+// created.
+bool sim_backdoor_open(sim_backdoor_t *b, const char *path, uint16_t *mem, size_t size);
+
+// To be called before evaluating each positive edge of clk
+void sim_backdoor_posedge(sim_backdoor_t *b, uint64_t cycles, Vtop *top);
+
+// Serves the client, waiting up to timeout_ms for a request. To be called
+// periodically, and repeatedly while the simulation is paused.
+void sim_backdoor_poll(sim_backdoor_t *b, uint64_t cycles, int timeout_ms);
+
+void sim_backdoor_close(sim_backdoor_t *b);
+
+#endif  // SIM_BACKDOOR_H
@@ -0,0 +1,66 @@
+// sim_cache_trace.cpp
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+#include "sim_cache_trace.h"
+
+#include <cstring>
+
+#include "cache_trace.h"
+
+bool sim_cache_trace_open(sim_cache_trace_t *c, const char *path)
+{
+    memset(c, 0, sizeof(*c));
+    if (!path)
+        return true;
+
+    c->f = fopen(path, "wb");
+    if (!c->f) {
+        perror(path);
+        return false;
+    }
+    setvbuf(c->f, nullptr, _IOFBF, 1 << 20);
+    fwrite(CACHE_TRACE_MAGIC, 1, CACHE_TRACE_MAGIC_SIZE, c->f);
+    return true;
+}
+
+static void write_record(sim_cache_trace_t *c, uint32_t record)
+{
+    uint8_t b[4] = {(uint8_t)record, (uint8_t)(record >> 8), (uint8_t)(record >> 16), (uint8_t)(record >> 24)};
+    fwrite(b, 1, sizeof(b), c->f);
+    c->nb_records++;
+}
+
+void sim_cache_trace_posedge(sim_cache_trace_t *c, Vtop *top)
+{
+    if (!c->f)
+        return;
+
+    if (top->cache_trace_flush_o && !c->flush) {
+        write_record(c, CACHE_TRACE_FLUSH);
+        c->has_last = false;
+    }
+    c->flush = top->cache_trace_flush_o;
+
+    // A request is served once it hits, after the line fill on a miss.
+    // The address bus of the CPU selects the cache for as long as it points
+    // to the memory: the repeated reads of a word are only recorded once.
+    if (!top->cache_trace_req_o)
+        return;
+    uint32_t record = cache_trace_record(top->cache_trace_addr_o, top->cache_trace_wmask_o, top->cache_trace_graphite_o);
+    if (c->has_last && record == c->last && !top->cache_trace_wmask_o)
+        return;
+    write_record(c, record);
+    c->last = record;
+    c->has_last = true;
+}
+
+void sim_cache_trace_close(sim_cache_trace_t *c)
+{
+    if (!c->f)
+        return;
+    long size = ftell(c->f);
+    fclose(c->f);
+    c->f = nullptr;
+    printf("Cache trace: %llu records (%ld bytes)\n", (unsigned long long)c->nb_records, size);
+}
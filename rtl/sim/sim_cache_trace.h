@@ -0,0 +1,32 @@
+// sim_cache_trace.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// Records the CPU and Graphite requests served by the cache controller,
+// exported by top.sv (CACHE_TRACE), in the format of cache_trace.h.
+
+#ifndef SIM_CACHE_TRACE_H
+#define SIM_CACHE_TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "Vtop.h"
+
+struct sim_cache_trace_t {
+    FILE *f;                    // nullptr if not recording
+    uint64_t nb_records;
+    uint32_t last;              // last request record
+    bool has_last;
+    bool flush;                 // flush in progress
+};
+
+// path may be nullptr for no trace
+bool sim_cache_trace_open(sim_cache_trace_t *c, const char *path);
+
+// To be called before evaluating each positive edge of clk
+void sim_cache_trace_posedge(sim_cache_trace_t *c, Vtop *top);
+
+void sim_cache_trace_close(sim_cache_trace_t *c);
+
+#endif  // SIM_CACHE_TRACE_H
@@ -0,0 +1,172 @@
+// sim_display.cpp
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+#include "sim_display.h"
+
+#include <cstdio>
+#include <cstring>
+
+// Flag of the middle buffer index: frame not presented yet
+#define NEW_FRAME 4
+
+#define FRAME_MS (1000 / 60)
+
+bool sim_display_open(sim_display_t *d, int screen_width, int screen_height, int vga_width, int vga_height)
+{
+    d->screen_width = screen_width;
+    d->screen_height = screen_height;
+    d->vga_width = vga_width;
+    d->vga_height = vga_height;
+
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        fprintf(stderr, "SDL_Init: %s\n", SDL_GetError());
+        return false;
+    }
+
+    d->window = SDL_CreateWindow(
+        "XGSoC Simulation",
+        SDL_WINDOWPOS_UNDEFINED_DISPLAY(1),
+        SDL_WINDOWPOS_UNDEFINED,
+        screen_width,
+        screen_height,
+        0);
+
+    d->renderer = SDL_CreateRenderer(d->window, -1, SDL_RENDERER_ACCELERATED);
+
+    d->texture = SDL_CreateTexture(d->renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, vga_width, vga_height);
+
+    size_t size = (size_t)vga_width * vga_height * 4;
+    for (int i = 0; i < 3; ++i) {
+        d->buffers[i] = new uint8_t[size];
+        memset(d->buffers[i], 0, size);
+    }
+    d->back = 0;
+    d->middle = 1;
+    d->front = 2;
+
+    d->led = 0;
+    d->stopped = false;
+    d->head = 0;
+    d->tail = 0;
+    return true;
+}
+
+static void push(sim_display_t *d, const sim_display_event_t &e)
+{
+    uint32_t head = d->head.load(std::memory_order_relaxed);
+    if (head - d->tail.load(std::memory_order_acquire) == SIM_DISPLAY_QUEUE_SIZE)
+        return;     // full: dropped
+    d->queue[head % SIM_DISPLAY_QUEUE_SIZE] = e;
+    d->head.store(head + 1, std::memory_order_release);
+}
+
+static void forward(sim_display_t *d, const SDL_Event &sdl_e)
+{
+    sim_display_event_t e = {};
+
+    if (sdl_e.type == SDL_QUIT) {
+        e.type = SIM_DISPLAY_QUIT;
+    } else if (sdl_e.type == SDL_KEYDOWN || sdl_e.type == SDL_KEYUP) {
+        if (sdl_e.key.repeat)
+            return;
+        e.type = sdl_e.type == SDL_KEYDOWN ? SIM_DISPLAY_KEY_DOWN : SIM_DISPLAY_KEY_UP;
+        e.sym = sdl_e.key.keysym.sym;
+        e.scancode = sdl_e.key.keysym.scancode;
+    } else if (sdl_e.type == SDL_MOUSEMOTION || sdl_e.type == SDL_MOUSEBUTTONDOWN ||
+               sdl_e.type == SDL_MOUSEBUTTONUP || sdl_e.type == SDL_MOUSEWHEEL) {
+        // PS/2 buttons: left, right, middle; y and z count upwards
+        uint32_t state = SDL_GetMouseState(nullptr, nullptr);
+        e.type = SIM_DISPLAY_MOUSE;
+        e.btn = ((state & SDL_BUTTON_LMASK) ? 1 : 0) |
+                ((state & SDL_BUTTON_RMASK) ? 2 : 0) |
+                ((state & SDL_BUTTON_MMASK) ? 4 : 0);
+        e.dx = sdl_e.type == SDL_MOUSEMOTION ? sdl_e.motion.xrel : 0;
+        e.dy = sdl_e.type == SDL_MOUSEMOTION ? -sdl_e.motion.yrel : 0;
+        e.dz = sdl_e.type == SDL_MOUSEWHEEL ? -sdl_e.wheel.y : 0;
+    } else {
+        return;
+    }
+
+    push(d, e);
+}
+
+static void render(sim_display_t *d)
+{
+    int draw_w, draw_h;
+    SDL_GL_GetDrawableSize(d->window, &draw_w, &draw_h);
+
+    int scale_x, scale_y;
+    scale_x = draw_w / d->screen_width;
+    scale_y = draw_h / d->screen_height;
+
+    SDL_SetRenderDrawColor(d->renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
+    SDL_RenderClear(d->renderer);
+
+    SDL_Rect vga_r = {0, scale_x * (d->screen_height - d->vga_height - 1), scale_x * d->vga_width, scale_y * d->vga_height};
+    SDL_RenderCopy(d->renderer, d->texture, NULL, &vga_r);
+
+    uint8_t led = d->led.load(std::memory_order_relaxed);
+    int x = 0;
+    int y = 0;
+    for (int i = 7; i >= 0; --i) {
+        SDL_Rect r{scale_x * x, scale_y * y, scale_x * 50, scale_y * 50};
+        SDL_SetRenderDrawColor(d->renderer, 30, (led >> i) & 1 ? 255 : 30, 30, 255);
+        SDL_RenderFillRect(d->renderer, &r);
+        x += 60;
+    }
+
+    SDL_RenderPresent(d->renderer);
+}
+
+void sim_display_run(sim_display_t *d)
+{
+    while (!d->stopped.load(std::memory_order_acquire)) {
+        uint32_t tp = SDL_GetTicks();
+
+        SDL_Event e;
+        while (SDL_PollEvent(&e))
+            forward(d, e);
+
+        if (d->middle.load(std::memory_order_acquire) & NEW_FRAME) {
+            d->front = d->middle.exchange(d->front, std::memory_order_acq_rel) & ~NEW_FRAME;
+            SDL_UpdateTexture(d->texture, NULL, d->buffers[d->front], d->vga_width * 4);
+        }
+
+        render(d);
+
+        uint32_t elapsed = SDL_GetTicks() - tp;
+        if (elapsed < FRAME_MS)
+            SDL_Delay(FRAME_MS - elapsed);
+    }
+}
+
+void sim_display_close(sim_display_t *d)
+{
+    SDL_DestroyTexture(d->texture);
+    SDL_DestroyRenderer(d->renderer);
+    SDL_DestroyWindow(d->window);
+    SDL_Quit();
+    for (int i = 0; i < 3; ++i)
+        delete[] d->buffers[i];
+}
+
+void sim_display_publish(sim_display_t *d)
+{
+    d->back = d->middle.exchange(d->back | NEW_FRAME, std::memory_order_acq_rel) & ~NEW_FRAME;
+}
+
+bool sim_display_poll(sim_display_t *d, sim_display_event_t *e)
+{
+    uint32_t tail = d->tail.load(std::memory_order_relaxed);
+    if (tail == d->head.load(std::memory_order_acquire))
+        return false;
+    *e = d->queue[tail % SIM_DISPLAY_QUEUE_SIZE];
+    d->tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+void sim_display_stop(sim_display_t *d)
+{
+    d->stopped.store(true, std::memory_order_release);
+}
@@ -0,0 +1,93 @@
+// sim_display.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// SDL front-end. The window is presented and its events are polled on the
+// main thread (as required by SDL on macOS), while the model is evaluated on
+// a simulation thread, so that neither waits for the other.
+//
+// The frames captured by the simulation thread are handed to the main
+// thread through a triple buffer: the simulation writes to the back buffer
+// and exchanges it with the middle one when the frame is complete, the main
+// thread exchanges the front buffer with the middle one when a new frame is
+// there. The keyboard, mouse and window events go the other way through a
+// single-producer single-consumer queue. Neither side takes a lock.
+
+#ifndef SIM_DISPLAY_H
+#define SIM_DISPLAY_H
+
+#include <SDL.h>
+
+#include <atomic>
+#include <stdint.h>
+
+// Input events, in SDL terms
+enum sim_display_event_type_t {
+    SIM_DISPLAY_QUIT,
+    SIM_DISPLAY_KEY_DOWN,
+    SIM_DISPLAY_KEY_UP,
+    SIM_DISPLAY_MOUSE
+};
+
+struct sim_display_event_t {
+    sim_display_event_type_t type;
+    SDL_Keycode sym;            // keys
+    SDL_Scancode scancode;
+    int btn;                    // mouse: PS/2 buttons, y and z count upwards
+    int dx, dy, dz;
+};
+
+#define SIM_DISPLAY_QUEUE_SIZE 256     // events, power of 2
+
+struct sim_display_t {
+    SDL_Window *window;
+    SDL_Renderer *renderer;
+    SDL_Texture *texture;
+    int screen_width, screen_height;
+    int vga_width, vga_height;
+
+    uint8_t *buffers[3];        // RGBA frames
+    int back;                   // simulation thread
+    int front;                  // main thread
+    std::atomic<int> middle;    // buffer index, flagged until presented
+
+    std::atomic<uint8_t> led;
+    std::atomic<bool> stopped;  // simulation done
+
+    sim_display_event_t queue[SIM_DISPLAY_QUEUE_SIZE];
+    std::atomic<uint32_t> head; // written by the main thread
+    std::atomic<uint32_t> tail; // written by the simulation thread
+};
+
+// Main thread
+bool sim_display_open(sim_display_t *d, int screen_width, int screen_height, int vga_width, int vga_height);
+
+// Main thread: presents the frames at 60 Hz and forwards the events until
+// sim_display_stop() is called
+void sim_display_run(sim_display_t *d);
+
+// Main thread
+void sim_display_close(sim_display_t *d);
+
+// Simulation thread: frame being captured
+static inline uint8_t *sim_display_back(sim_display_t *d)
+{
+    return d->buffers[d->back];
+}
+
+// Simulation thread: the back buffer holds a complete frame
+void sim_display_publish(sim_display_t *d);
+
+// Simulation thread: next input event, false if none
+bool sim_display_poll(sim_display_t *d, sim_display_event_t *e);
+
+// Simulation thread
+static inline void sim_display_led(sim_display_t *d, uint8_t led)
+{
+    d->led.store(led, std::memory_order_relaxed);
+}
+
+// Simulation thread: ends sim_display_run()
+void sim_display_stop(sim_display_t *d);
+
+#endif  // SIM_DISPLAY_H
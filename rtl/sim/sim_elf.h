@@ -0,0 +1,137 @@
+// sim_elf.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// ELF32 definitions (<elf.h> is not available on all hosts)
+
+#ifndef SIM_ELF_H
+#define SIM_ELF_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define EI_NIDENT   16
+#define ELFCLASS32  1
+#define PT_LOAD     1
+#define SHT_SYMTAB  2
+#define STT_FUNC    2
+
+#define ELF32_ST_TYPE(i) ((i) & 0xf)
+
+struct elf32_ehdr {
+    uint8_t  e_ident[EI_NIDENT];
+    uint16_t e_type;
+    uint16_t e_machine;
+    uint32_t e_version;
+    uint32_t e_entry;
+    uint32_t e_phoff;
+    uint32_t e_shoff;
+    uint32_t e_flags;
+    uint16_t e_ehsize;
+    uint16_t e_phentsize;
+    uint16_t e_phnum;
+    uint16_t e_shentsize;
+    uint16_t e_shnum;
+    uint16_t e_shstrndx;
+};
+
+struct elf32_phdr {
+    uint32_t p_type;
+    uint32_t p_offset;
+    uint32_t p_vaddr;
+    uint32_t p_paddr;
+    uint32_t p_filesz;
+    uint32_t p_memsz;
+    uint32_t p_flags;
+    uint32_t p_align;
+};
+
+struct elf32_shdr {
+    uint32_t sh_name;
+    uint32_t sh_type;
+    uint32_t sh_flags;
+    uint32_t sh_addr;
+    uint32_t sh_offset;
+    uint32_t sh_size;
+    uint32_t sh_link;
+    uint32_t sh_info;
+    uint32_t sh_addralign;
+    uint32_t sh_entsize;
+};
+
+struct elf32_sym {
+    uint32_t st_name;
+    uint32_t st_value;
+    uint32_t st_size;
+    uint8_t  st_info;
+    uint8_t  st_other;
+    uint16_t st_shndx;
+};
+
+static inline bool elf_is_elf(const uint8_t *data, size_t len)
+{
+    return len >= 4 && data[0] == 0x7F && data[1] == 'E' && data[2] == 'L' && data[3] == 'F';
+}
+
+// Calls f(sym, name, name_len) for the symbols of the ELF file at <path>
+// until it returns false. Returns false if the file cannot be mapped.
+template <class F>
+static bool elf_for_each_symbol(const char *path, F f)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    size_t len = (size_t)st.st_size;
+    void *m = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED)
+        return false;
+
+    const uint8_t *data = (const uint8_t *)m;
+    bool more = true;
+    elf32_ehdr ehdr;
+    if (elf_is_elf(data, len) && len >= sizeof(ehdr)) {
+        memcpy(&ehdr, data, sizeof(ehdr));
+        for (int i = 0; more && ehdr.e_ident[4] == ELFCLASS32 && i < ehdr.e_shnum; ++i) {
+            elf32_shdr shdr, strhdr;
+            size_t off = ehdr.e_shoff + (size_t)i * ehdr.e_shentsize;
+            if (off + sizeof(shdr) > len)
+                break;
+            memcpy(&shdr, data + off, sizeof(shdr));
+            if (shdr.sh_type != SHT_SYMTAB || shdr.sh_link >= ehdr.e_shnum)
+                continue;
+            off = ehdr.e_shoff + (size_t)shdr.sh_link * ehdr.e_shentsize;
+            if (off + sizeof(strhdr) > len)
+                break;
+            memcpy(&strhdr, data + off, sizeof(strhdr));
+            if ((size_t)shdr.sh_offset + shdr.sh_size > len || (size_t)strhdr.sh_offset + strhdr.sh_size > len)
+                break;
+
+            for (size_t k = 0; more && k < shdr.sh_size / sizeof(elf32_sym); ++k) {
+                elf32_sym sym;
+                memcpy(&sym, data + shdr.sh_offset + k * sizeof(sym), sizeof(sym));
+                if (sym.st_name >= strhdr.sh_size)
+                    continue;
+                const char *name = (const char *)data + strhdr.sh_offset + sym.st_name;
+                more = f(sym, name, strnlen(name, strhdr.sh_size - sym.st_name));
+            }
+        }
+    }
+
+    munmap(m, len);
+    return true;
+}
+
+#endif  // SIM_ELF_H
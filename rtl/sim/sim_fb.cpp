@@ -0,0 +1,269 @@
+// sim_fb.cpp
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+#include "sim_fb.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+bool sim_fb_open(sim_fb_t *fb, const char *frames, const char *prefix, const char *format,
+                 const char *golden, int tolerance)
+{
+    *fb = sim_fb_t();
+    fb->prefix = prefix;
+    fb->golden = golden ? golden : "";
+    fb->tolerance = tolerance;
+    fb->rgb.resize(SIM_FB_WIDTH * SIM_FB_HEIGHT * 3);
+
+    if (!strcmp(format, "png")) {
+        fb->png = true;
+    } else if (strcmp(format, "ppm")) {
+        fprintf(stderr, "Unknown frame format: %s\n", format);
+        return false;
+    }
+
+    const char *p = frames;
+    while (*p) {
+        char *end;
+        uint64_t n = strtoull(p, &end, 0);
+        if (end == p || (*end && *end != ',')) {
+            fprintf(stderr, "Invalid frame list: %s\n", frames);
+            return false;
+        }
+        fb->frames.push_back(n);
+        p = *end ? end + 1 : end;
+    }
+    std::sort(fb->frames.begin(), fb->frames.end());
+    fb->frames.erase(std::unique(fb->frames.begin(), fb->frames.end()), fb->frames.end());
+
+    return true;
+}
+
+static uint64_t fnv1a(const uint8_t *data, size_t len)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; ++i) {
+        h ^= data[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+static bool write_ppm(const char *path, const uint8_t *rgb)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", SIM_FB_WIDTH, SIM_FB_HEIGHT);
+    fwrite(rgb, 1, SIM_FB_WIDTH * SIM_FB_HEIGHT * 3, f);
+    fclose(f);
+    return true;
+}
+
+static uint32_t crc32(uint32_t crc, const uint8_t *data, size_t len)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= data[i];
+        for (int k = 0; k < 8; ++k)
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+    return ~crc;
+}
+
+static void put_be32(std::vector<uint8_t> &v, uint32_t x)
+{
+    v.push_back(x >> 24);
+    v.push_back(x >> 16);
+    v.push_back(x >> 8);
+    v.push_back(x);
+}
+
+static void png_chunk(FILE *f, const char *type, const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> chunk;
+    put_be32(chunk, (uint32_t)data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    put_be32(chunk, crc32(0, &chunk[4], chunk.size() - 4));
+    fwrite(chunk.data(), 1, chunk.size(), f);
+}
+
+// Uncompressed PNG (stored deflate blocks), no zlib dependency
+static bool write_png(const char *path, const uint8_t *rgb)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+
+    static const uint8_t signature[] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    fwrite(signature, 1, sizeof(signature), f);
+
+    std::vector<uint8_t> ihdr;
+    put_be32(ihdr, SIM_FB_WIDTH);
+    put_be32(ihdr, SIM_FB_HEIGHT);
+    ihdr.insert(ihdr.end(), {8, 2, 0, 0, 0});   // 8-bit RGB, no interlace
+    png_chunk(f, "IHDR", ihdr);
+
+    // Scanlines with filter type 0
+    const size_t stride = SIM_FB_WIDTH * 3;
+    std::vector<uint8_t> raw;
+    raw.reserve((stride + 1) * SIM_FB_HEIGHT);
+    for (int y = 0; y < SIM_FB_HEIGHT; ++y) {
+        raw.push_back(0);
+        raw.insert(raw.end(), rgb + y * stride, rgb + (y + 1) * stride);
+    }
+
+    std::vector<uint8_t> idat = {0x78, 0x01};
+    uint32_t a = 1, b = 0;  // Adler-32
+    for (size_t pos = 0; pos < raw.size();) {
+        size_t len = std::min(raw.size() - pos, (size_t)65535);
+        idat.push_back(pos + len == raw.size() ? 1 : 0);
+        idat.push_back(len);
+        idat.push_back(len >> 8);
+        idat.push_back(~len);
+        idat.push_back(~len >> 8);
+        for (size_t i = pos; i < pos + len; ++i) {
+            a = (a + raw[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+        idat.insert(idat.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    }
+    put_be32(idat, b << 16 | a);
+    png_chunk(f, "IDAT", idat);
+    png_chunk(f, "IEND", {});
+
+    fclose(f);
+    return true;
+}
+
+// Binary PPM (P6) with 8-bit components
+static bool read_ppm(const char *path, std::vector<uint8_t> &rgb, int *width, int *height)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+
+    int maxval;
+    bool ok = fscanf(f, "P6 %d %d %d", width, height, &maxval) == 3 && maxval == 255 && fgetc(f) != EOF;
+    if (ok) {
+        rgb.resize((size_t)*width * *height * 3);
+        ok = fread(rgb.data(), 1, rgb.size(), f) == rgb.size();
+    }
+    fclose(f);
+
+    if (!ok)
+        fprintf(stderr, "%s: unsupported PPM image\n", path);
+    return ok;
+}
+
+static bool compare(sim_fb_t *fb, const char *path)
+{
+    std::vector<uint8_t> golden;
+    int width, height;
+    if (!read_ppm(path, golden, &width, &height))
+        return false;
+    if (width != SIM_FB_WIDTH || height != SIM_FB_HEIGHT) {
+        printf("Frame %" PRIu64 ": %s is %dx%d, expected %dx%d\n", fb->frame, path,
+               width, height, SIM_FB_WIDTH, SIM_FB_HEIGHT);
+        return false;
+    }
+
+    size_t diff_pixels = 0;
+    int max_diff = 0;
+    for (size_t i = 0; i < golden.size(); i += 3) {
+        int d = 0;
+        for (int c = 0; c < 3; ++c)
+            d = std::max(d, abs((int)fb->rgb[i + c] - (int)golden[i + c]));
+        if (d > fb->tolerance)
+            diff_pixels++;
+        max_diff = std::max(max_diff, d);
+    }
+
+    printf("Frame %" PRIu64 ": %s, %zu pixels differ (max. difference %d)\n", fb->frame,
+           diff_pixels ? "FAIL" : "pass", diff_pixels, max_diff);
+    return diff_pixels == 0;
+}
+
+static void end_frame(sim_fb_t *fb, uint64_t cycles)
+{
+    uint64_t hash = fnv1a(fb->rgb.data(), fb->rgb.size());
+    if (hash != fb->hash || fb->frame == 0) {
+        fb->render_cycles = cycles - fb->change_cycle;
+        fb->change_cycle = cycles;
+        fb->hash = hash;
+    }
+
+    if (!sim_fb_done(fb) && fb->frames[fb->next] == fb->frame) {
+        fb->next++;
+
+        printf("Frame %" PRIu64 ": cycle %" PRIu64 ", render %" PRIu64 " cycles, hash %016" PRIx64 "\n",
+               fb->frame, cycles, fb->render_cycles, hash);
+
+        char path[1024];
+        snprintf(path, sizeof(path), "%s_%" PRIu64 ".%s", fb->prefix.c_str(), fb->frame, fb->png ? "png" : "ppm");
+        if (!(fb->png ? write_png(path, fb->rgb.data()) : write_ppm(path, fb->rgb.data())))
+            fb->failures++;
+
+        if (!fb->golden.empty()) {
+            snprintf(path, sizeof(path), "%s_%" PRIu64 ".ppm", fb->golden.c_str(), fb->frame);
+            if (!compare(fb, path))
+                fb->failures++;
+        }
+    }
+
+    fb->frame++;
+}
+
+void sim_fb_posedge(sim_fb_t *fb, uint64_t cycles, Vtop *top)
+{
+    // vga_vsync is active low
+    bool vsync = !top->vga_vsync;
+    if (vsync != fb->vsync) {
+        fb->vsync = vsync;
+        if (vsync) {
+            if (fb->synced)
+                end_frame(fb, cycles);
+        } else {
+            fb->synced = true;
+            fb->blank = true;
+            fb->x = 0;
+            fb->y = 0;
+            std::fill(fb->rgb.begin(), fb->rgb.end(), 0);
+        }
+    }
+
+    if (!fb->synced)
+        return;
+
+    if (!top->vga_blank) {
+        if (fb->x < SIM_FB_WIDTH && fb->y < SIM_FB_HEIGHT) {
+            uint8_t *p = &fb->rgb[(fb->y * SIM_FB_WIDTH + fb->x) * 3];
+            p[0] = top->vga_r;
+            p[1] = top->vga_g;
+            p[2] = top->vga_b;
+        }
+        fb->x++;
+    } else if (!fb->blank) {
+        // End of a visible line
+        fb->x = 0;
+        fb->y++;
+    }
+    fb->blank = top->vga_blank;
+}
+
+bool sim_fb_done(const sim_fb_t *fb)
+{
+    return fb->next >= fb->frames.size();
+}
@@ -0,0 +1,58 @@
+// sim_fb.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// Frame capture. Assembles the visible pixels of each frame from the VGA
+// outputs, dumps the requested frames (PPM or PNG) and compares them against
+// golden PPM images. For each captured frame, the render time is the number
+// of CPU cycles between the previous change of the frame content and the
+// change that produced this one (at frame granularity).
+
+#ifndef SIM_FB_H
+#define SIM_FB_H
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "Vtop.h"
+
+#define SIM_FB_WIDTH    640
+#define SIM_FB_HEIGHT   480
+
+struct sim_fb_t {
+    std::vector<uint64_t> frames;   // frames to capture, in increasing order
+    size_t next;                    // next frame to capture
+    std::string prefix;             // dumps: <prefix>_<frame>.ppm|.png
+    bool png;
+    std::string golden;             // golden images: <golden>_<frame>.ppm
+    int tolerance;                  // max difference per color component
+    int failures;
+
+    // Scan-out
+    std::vector<uint8_t> rgb;       // RGB888, SIM_FB_WIDTH * SIM_FB_HEIGHT
+    bool synced;                    // a frame started at the end of a vsync
+    bool vsync;
+    bool blank;
+    int x, y;
+    uint64_t frame;                 // current frame number
+
+    // Content changes
+    uint64_t hash;
+    uint64_t change_cycle;          // end of the last frame with new content
+    uint64_t render_cycles;         // between the last two content changes
+};
+
+// frames: comma-separated list of frame numbers. format: "ppm" or "png".
+// golden may be nullptr. Returns false if an argument is invalid.
+bool sim_fb_open(sim_fb_t *fb, const char *frames, const char *prefix, const char *format,
+                 const char *golden, int tolerance);
+
+// To be called before evaluating each positive edge of clk
+void sim_fb_posedge(sim_fb_t *fb, uint64_t cycles, Vtop *top);
+
+// All the requested frames have been captured
+bool sim_fb_done(const sim_fb_t *fb);
+
+#endif  // SIM_FB_H
@@ -0,0 +1,509 @@
+// sim_gdb.cpp
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+#include "sim_gdb.h"
+#include "sim_rtl.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "Vtop___024root.h"
+
+// Register numbers of the target description below
+#define REG_PC      32
+#define REG_F0      33
+#define REG_FFLAGS  66
+#define REG_FCSR    68
+
+static const char target_xml[] =
+    "<?xml version=\"1.0\"?>\n"
+    "<!DOCTYPE target SYSTEM \"gdb-target.dtd\">\n"
+    "<target version=\"1.0\">\n"
+    "<architecture>riscv:rv32</architecture>\n"
+    "<feature name=\"org.gnu.gdb.riscv.cpu\">\n"
+    "<reg name=\"zero\" bitsize=\"32\" type=\"int\" regnum=\"0\"/>\n"
+    "<reg name=\"ra\" bitsize=\"32\" type=\"code_ptr\"/>\n"
+    "<reg name=\"sp\" bitsize=\"32\" type=\"data_ptr\"/>\n"
+    "<reg name=\"gp\" bitsize=\"32\" type=\"data_ptr\"/>\n"
+    "<reg name=\"tp\" bitsize=\"32\" type=\"data_ptr\"/>\n"
+    "<reg name=\"t0\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"t1\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"t2\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"fp\" bitsize=\"32\" type=\"data_ptr\"/>\n"
+    "<reg name=\"s1\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"a0\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"a1\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"a2\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"a3\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"a4\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"a5\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"a6\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"a7\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"s2\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"s3\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"s4\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"s5\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"s6\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"s7\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"s8\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"s9\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"s10\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"s11\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"t3\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"t4\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"t5\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"t6\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"pc\" bitsize=\"32\" type=\"code_ptr\"/>\n"
+    "</feature>\n"
+    "<feature name=\"org.gnu.gdb.riscv.fpu\">\n"
+    "<reg name=\"ft0\" bitsize=\"32\" type=\"ieee_single\" regnum=\"33\"/>\n"
+    "<reg name=\"ft1\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"ft2\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"ft3\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"ft4\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"ft5\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"ft6\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"ft7\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fs0\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fs1\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fa0\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fa1\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fa2\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fa3\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fa4\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fa5\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fa6\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fa7\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fs2\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fs3\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fs4\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fs5\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fs6\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fs7\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fs8\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fs9\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fs10\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fs11\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"ft8\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"ft9\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"ft10\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"ft11\" bitsize=\"32\" type=\"ieee_single\"/>\n"
+    "<reg name=\"fflags\" bitsize=\"32\" type=\"int\" regnum=\"66\"/>\n"
+    "<reg name=\"frm\" bitsize=\"32\" type=\"int\"/>\n"
+    "<reg name=\"fcsr\" bitsize=\"32\" type=\"int\"/>\n"
+    "</feature>\n"
+    "</target>\n";
+
+#define XFER_TARGET "qXfer:features:read:target.xml:"
+
+static IData &cpu_reg(Vtop *top, int i)
+{
+    return top->rootp->top__DOT__soc_top__DOT__processor__DOT__registerFile[i];
+}
+
+bool sim_gdb_open(sim_gdb_t *g, int port, uint16_t *mem, size_t size)
+{
+    *g = sim_gdb_t();
+    g->listen_fd = -1;
+    g->fd = -1;
+    g->mem = (uint8_t *)mem;
+    g->size = size;
+
+    if (!port)
+        return true;
+
+    struct sockaddr_in sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sin_family = AF_INET;
+    sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    sa.sin_port = htons(port);
+
+    int one = 1;
+    g->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (g->listen_fd < 0 || setsockopt(g->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) < 0 ||
+        bind(g->listen_fd, (struct sockaddr *)&sa, sizeof(sa)) < 0 || listen(g->listen_fd, 1) < 0) {
+        perror("gdb stub");
+        if (g->listen_fd >= 0)
+            close(g->listen_fd);
+        g->listen_fd = -1;
+        return false;
+    }
+
+    // Halted on the first instruction until gdb continues
+    g->stepping = true;
+    g->executed = true;
+    g->signal = SIGTRAP;
+
+    printf("Waiting for gdb on port %d\n", port);
+    return true;
+}
+
+static void disconnect(sim_gdb_t *g)
+{
+    close(g->fd);
+    g->fd = -1;
+    g->rx.clear();
+    g->breakpoints.clear();
+    g->halted = false;
+    g->stepping = false;
+}
+
+static bool send_all(sim_gdb_t *g, const char *p, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = send(g->fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            disconnect(g);
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+// The acknowledgment ('+') of the client is not waited for: the connection
+// is reliable
+static bool send_packet(sim_gdb_t *g, const std::string &data)
+{
+    uint8_t checksum = 0;
+    for (char c : data)
+        checksum += (uint8_t)c;
+    char trailer[4];
+    snprintf(trailer, sizeof(trailer), "#%02x", checksum);
+    return send_all(g, "$", 1) && send_all(g, data.data(), data.size()) && send_all(g, trailer, 3);
+}
+
+static void send_stop(sim_gdb_t *g)
+{
+    char s[4];
+    snprintf(s, sizeof(s), "S%02x", g->signal);
+    send_packet(g, s);
+}
+
+static void append_hex(std::string &s, const uint8_t *data, size_t len)
+{
+    static const char digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < len; ++i) {
+        s += digits[data[i] >> 4];
+        s += digits[data[i] & 15];
+    }
+}
+
+static bool parse_hex(const char *s, size_t len, uint8_t *data)
+{
+    for (size_t i = 0; i < len; ++i) {
+        char byte[3] = {s[2 * i], s[2 * i + 1], 0};
+        char *end;
+        data[i] = (uint8_t)strtoul(byte, &end, 16);
+        if (end != byte + 2)
+            return false;
+    }
+    return true;
+}
+
+// Registers are sent in target byte order (little-endian)
+static void append_reg(std::string &s, uint32_t value)
+{
+    uint8_t bytes[4] = {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)};
+    append_hex(s, bytes, 4);
+}
+
+static bool parse_reg(const char *s, uint32_t *value)
+{
+    uint8_t bytes[4];
+    if (!parse_hex(s, 4, bytes))
+        return false;
+    *value = bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+    return true;
+}
+
+static bool read_reg(Vtop *top, int n, uint32_t *value)
+{
+    if (n >= 0 && n < REG_PC)
+        *value = cpu_reg(top, n);
+    else if (n == REG_PC)
+        *value = top->cpu_pc_o;
+    else if (n >= REG_F0 && n < REG_F0 + 32)
+        *value = cpu_reg(top, 32 + n - REG_F0);
+    else if (n >= REG_FFLAGS && n <= REG_FCSR)
+        *value = 0;     // no floating-point CSRs
+    else
+        return false;
+    return true;
+}
+
+static bool write_reg(Vtop *top, int n, uint32_t value)
+{
+    if (n == 0 || (n >= REG_FFLAGS && n <= REG_FCSR))
+        return true;    // hardwired to 0
+    if (n > 0 && n < REG_PC)
+        cpu_reg(top, n) = value;
+    else if (n == REG_PC)
+        return value == top->cpu_pc_o;
+    else if (n >= REG_F0 && n < REG_F0 + 32)
+        cpu_reg(top, 32 + n - REG_F0) = value;
+    else
+        return false;
+    return true;
+}
+
+// Registers of the 'g' and 'G' packets, in order
+static int next_reg(int n)
+{
+    return n == REG_F0 + 31 ? REG_FFLAGS : n + 1;
+}
+
+static bool in_range(sim_gdb_t *g, uint32_t addr, uint32_t len)
+{
+    return addr <= g->size && len <= g->size - addr;
+}
+
+static void resume(sim_gdb_t *g, bool step)
+{
+    g->halted = false;
+    g->stepping = step;
+    g->executed = false;
+}
+
+static void serve(sim_gdb_t *g, Vtop *top, const std::string &p)
+{
+    const char *s = p.c_str();
+    std::string r;
+
+    switch (s[0]) {
+        case '?':
+            // Answered once stopped if attached to a running simulation
+            if (g->halted)
+                send_stop(g);
+            else
+                g->stepping = true;
+            return;
+
+        case 'g':
+            for (int n = 0; n <= REG_FCSR; n = next_reg(n)) {
+                uint32_t value;
+                read_reg(top, n, &value);
+                append_reg(r, value);
+            }
+            break;
+
+        case 'G': {
+            size_t i = 1;
+            for (int n = 0; n <= REG_FCSR && i + 8 <= p.size(); n = next_reg(n), i += 8) {
+                uint32_t value;
+                if (!parse_reg(s + i, &value) || !write_reg(top, n, value)) {
+                    r = "E01";
+                    break;
+                }
+            }
+            if (r.empty())
+                r = "OK";
+            break;
+        }
+
+        case 'p': {
+            uint32_t value;
+            if (read_reg(top, (int)strtol(s + 1, nullptr, 16), &value))
+                append_reg(r, value);
+            else
+                r = "E01";
+            break;
+        }
+
+        case 'P': {
+            char *end;
+            int n = (int)strtol(s + 1, &end, 16);
+            uint32_t value;
+            r = *end == '=' && parse_reg(end + 1, &value) && write_reg(top, n, value) ? "OK" : "E01";
+            break;
+        }
+
+        case 'm': {
+            char *end;
+            uint32_t addr = strtoul(s + 1, &end, 16);
+            uint32_t len = *end == ',' ? strtoul(end + 1, nullptr, 16) : 0;
+            if (in_range(g, addr, len))
+                append_hex(r, g->mem + addr, len);
+            else
+                r = "E01";
+            break;
+        }
+
+        case 'M': {
+            char *end;
+            uint32_t addr = strtoul(s + 1, &end, 16);
+            uint32_t len = *end == ',' ? strtoul(end + 1, &end, 16) : 0;
+            r = *end == ':' && strlen(end + 1) == 2 * len && in_range(g, addr, len) &&
+                parse_hex(end + 1, len, g->mem + addr) ? "OK" : "E01";
+            break;
+        }
+
+        case 'c':
+        case 's':
+            // Resuming at another address is not supported
+            if (s[1] && strtoul(s + 1, nullptr, 16) != top->cpu_pc_o) {
+                r = "E01";
+                break;
+            }
+            resume(g, s[0] == 's');
+            return;
+
+        case 'Z':
+        case 'z': {
+            // Software and hardware breakpoints are both PC matches
+            if (s[1] != '0' && s[1] != '1')
+                break;
+            uint32_t addr = strtoul(s + 3, nullptr, 16);
+            auto it = std::find(g->breakpoints.begin(), g->breakpoints.end(), addr);
+            if (s[0] == 'Z' && it == g->breakpoints.end())
+                g->breakpoints.push_back(addr);
+            else if (s[0] == 'z' && it != g->breakpoints.end())
+                g->breakpoints.erase(it);
+            r = "OK";
+            break;
+        }
+
+        case 'q':
+            if (!strncmp(s, "qSupported", 10)) {
+                r = "PacketSize=4000;qXfer:features:read+";
+            } else if (!strcmp(s, "qAttached")) {
+                r = "1";
+            } else if (!strncmp(s, XFER_TARGET, sizeof(XFER_TARGET) - 1)) {
+                char *end;
+                size_t offset = strtoul(s + sizeof(XFER_TARGET) - 1, &end, 16);
+                size_t len = *end == ',' ? strtoul(end + 1, nullptr, 16) : 0;
+                size_t size = sizeof(target_xml) - 1;
+                offset = std::min(offset, size);
+                len = std::min(len, size - offset);
+                r = offset + len < size ? "m" : "l";
+                r.append(target_xml + offset, len);
+            }
+            break;
+
+        case 'H':
+        case 'T':
+            r = "OK";
+            break;
+
+        case 'D':
+            send_packet(g, "OK");
+            disconnect(g);
+            return;
+
+        case 'k':
+            g->killed = true;
+            disconnect(g);
+            return;
+    }
+
+    // Unsupported packets get an empty reply
+    send_packet(g, r);
+}
+
+void sim_gdb_posedge(sim_gdb_t *g, Vtop *top)
+{
+    if (g->listen_fd < 0 || !top->cpu_ce_o)
+        return;
+
+    if (top->cpu_state_o & CPU_STATE_EXECUTE) {
+        g->executed = true;
+        return;
+    }
+
+    // First fetch of the next instruction (unaligned ones are fetched twice)
+    if (!(top->cpu_state_o & CPU_STATE_WAIT_INSTR) || !g->executed)
+        return;
+    g->executed = false;
+
+    bool breakpoint = std::find(g->breakpoints.begin(), g->breakpoints.end(), top->cpu_pc_o) != g->breakpoints.end();
+    if (!g->stepping && !breakpoint)
+        return;
+
+    g->halted = true;
+    if (g->fd >= 0)
+        send_stop(g);
+    g->signal = SIGTRAP;
+}
+
+void sim_gdb_poll(sim_gdb_t *g, Vtop *top, int timeout_ms)
+{
+    if (g->listen_fd < 0)
+        return;
+
+    if (g->fd < 0) {
+        struct pollfd pfd = {g->listen_fd, POLLIN, 0};
+        if (poll(&pfd, 1, timeout_ms) <= 0)
+            return;
+        g->fd = accept(g->listen_fd, nullptr, nullptr);
+        if (g->fd < 0)
+            return;
+        int one = 1;
+        setsockopt(g->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        timeout_ms = 0;
+    }
+
+    struct pollfd pfd = {g->fd, POLLIN, 0};
+    while (g->fd >= 0 && poll(&pfd, 1, timeout_ms) > 0) {
+        char buf[4096];
+        ssize_t n = recv(g->fd, buf, sizeof(buf), 0);
+        if (n <= 0) {
+            disconnect(g);
+            return;
+        }
+        g->rx.append(buf, n);
+
+        for (;;) {
+            // Interrupt (Ctrl-C): stop on the next instruction
+            size_t start = g->rx.find_first_of("$\x03");
+            if (start == std::string::npos) {
+                g->rx.clear();
+                break;
+            }
+            if (g->rx[start] == '\x03') {
+                g->rx.erase(0, start + 1);
+                if (!g->halted) {
+                    g->stepping = true;
+                    g->signal = SIGINT;
+                }
+                continue;
+            }
+            size_t end = g->rx.find('#', start);
+            if (end == std::string::npos || end + 3 > g->rx.size()) {
+                g->rx.erase(0, start);
+                break;
+            }
+            std::string packet = g->rx.substr(start + 1, end - start - 1);
+            g->rx.erase(0, end + 3);
+            if (!send_all(g, "+", 1))
+                return;
+            serve(g, top, packet);
+        }
+
+        // Drain what is already there, then return
+        timeout_ms = 0;
+    }
+}
+
+void sim_gdb_close(sim_gdb_t *g)
+{
+    if (g->fd >= 0)
+        close(g->fd);
+    if (g->listen_fd >= 0)
+        close(g->listen_fd);
+    g->fd = -1;
+    g->listen_fd = -1;
+}
@@ -0,0 +1,60 @@
+// sim_gdb.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// GDB remote stub. gdb connects to a TCP port (target remote :<port>) and
+// controls the simulated CPU: register and memory read/write, breakpoints,
+// single-step and continue. The simulation starts halted on the first
+// instruction and, while halted, stops evaluating the model altogether.
+//
+// The CPU is stopped before the positive edge of clk that decodes the
+// instruction at PC (WAIT_INSTR), so that the registers written by gdb are
+// the ones read by this instruction. The breakpoints compare the PC of the
+// decoded instructions: the program memory is not patched. The PC cannot be
+// written (jump, call).
+//
+// The memory is read from and written to the SDRAM array directly, like the
+// memory backdoor: the lines held in the write-back cache are not seen until
+// they are written back.
+
+#ifndef SIM_GDB_H
+#define SIM_GDB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "Vtop.h"
+
+struct sim_gdb_t {
+    int listen_fd;
+    int fd;                     // client, -1 if none
+    std::string rx;             // partial packet
+
+    uint8_t *mem;
+    size_t size;
+
+    std::vector<uint32_t> breakpoints;
+    bool halted;
+    bool stepping;              // stop on the next instruction
+    bool executed;              // an instruction was executed since the last stop
+    int signal;                 // of the last stop
+    bool killed;                // the simulation must quit
+};
+
+// port may be 0 for no stub. Returns false if the socket cannot be created.
+bool sim_gdb_open(sim_gdb_t *g, int port, uint16_t *mem, size_t size);
+
+// To be called before evaluating each positive edge of clk, then
+// sim_gdb_poll() repeatedly while halted
+void sim_gdb_posedge(sim_gdb_t *g, Vtop *top);
+
+// Serves the client, waiting up to timeout_ms for a packet. To be called
+// periodically, and repeatedly while the CPU is halted.
+void sim_gdb_poll(sim_gdb_t *g, Vtop *top, int timeout_ms);
+
+void sim_gdb_close(sim_gdb_t *g);
+
+#endif  // SIM_GDB_H
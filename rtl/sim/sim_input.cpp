@@ -0,0 +1,314 @@
+// sim_input.cpp
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+#include "sim_input.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+
+#define PS2_BREAK           0xF0
+#define PS2_LSHIFT          0x12
+
+struct ascii_key_t {
+    uint8_t code;
+    bool shift;
+};
+
+// PS/2 set 2 make code of a printable or control character, 0 if none
+static ascii_key_t ascii_key(unsigned char c)
+{
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyz";
+    static const uint8_t letter_codes[] = {
+        0x1C, 0x32, 0x21, 0x23, 0x24, 0x2B, 0x34, 0x33, 0x43, 0x3B, 0x42, 0x4B, 0x3A,
+        0x31, 0x44, 0x4D, 0x15, 0x2D, 0x1B, 0x2C, 0x3C, 0x2A, 0x1D, 0x22, 0x35, 0x1A
+    };
+    // Same keys, without and with shift
+    static const char symbols[] = "1234567890`-=[]\\;',./";
+    static const char shifted[] = "!@#$%^&*()~_+{}|:\"<>?";
+    static const uint8_t symbol_codes[] = {
+        0x16, 0x1E, 0x26, 0x25, 0x2E, 0x36, 0x3D, 0x3E, 0x46, 0x45,
+        0x0E, 0x4E, 0x55, 0x54, 0x5B, 0x5D, 0x4C, 0x52, 0x41, 0x49, 0x4A
+    };
+
+    switch (c) {
+        case ' ':  return {0x29, false};
+        case '\n': return {0x5A, false};
+        case '\t': return {0x0D, false};
+        case '\b': return {0x66, false};
+        case 0x1B: return {0x76, false};
+    }
+
+    const char *p;
+    if (islower(c) && (p = strchr(letters, c)))
+        return {letter_codes[p - letters], false};
+    if (isupper(c) && (p = strchr(letters, tolower(c))))
+        return {letter_codes[p - letters], true};
+    if (c && (p = strchr(symbols, c)))
+        return {symbol_codes[p - symbols], false};
+    if (c && (p = strchr(shifted, c)))
+        return {symbol_codes[p - shifted], true};
+    return {0, false};
+}
+
+static void add_event(sim_input_t *in, uint64_t cycle, bool mouse, uint32_t data)
+{
+    in->script.push_back({cycle, mouse, data});
+}
+
+static uint32_t mouse_word(int btn, int dx, int dy, int dz)
+{
+    return (uint32_t)(btn & 0x7) << 24 | (uint32_t)(dx & 0xFF) << 16 | (uint32_t)(dy & 0xFF) << 8 | (uint32_t)(dz & 0xFF);
+}
+
+static bool parse_line(sim_input_t *in, char *line, uint64_t *last_cycle)
+{
+    char *p = line;
+    while (isspace((unsigned char)*p))
+        ++p;
+    if (*p == '\0' || *p == '#')
+        return true;
+
+    bool relative = *p == '+';
+    if (relative)
+        ++p;
+    char *end;
+    uint64_t cycle = strtoull(p, &end, 0);
+    if (end == p)
+        return false;
+    if (relative)
+        cycle += *last_cycle;
+    if (cycle < *last_cycle)
+        return false;   // the events must be in order
+    *last_cycle = cycle;
+
+    p = end;
+    while (isspace((unsigned char)*p))
+        ++p;
+    char *cmd = p;
+    while (*p && !isspace((unsigned char)*p))
+        ++p;
+    size_t cmd_len = p - cmd;
+    if (*p)
+        ++p;    // single separator, the text of "type" may start with spaces
+
+    if (cmd_len == 3 && !strncmp(cmd, "kbd", 3)) {
+        for (;;) {
+            unsigned long code = strtoul(p, &end, 16);
+            if (end == p)
+                break;
+            if (code > 0xFF)
+                return false;
+            add_event(in, cycle, false, (uint32_t)code);
+            p = end;
+        }
+        while (isspace((unsigned char)*p))
+            ++p;
+        return *p == '\0';
+    } else if (cmd_len == 4 && !strncmp(cmd, "type", 4)) {
+        p[strcspn(p, "\r\n")] = '\0';
+        for (; *p; ++p) {
+            unsigned char c = *p;
+            if (c == '\\') {
+                switch (*++p) {
+                    case 'n':  c = '\n'; break;
+                    case 't':  c = '\t'; break;
+                    case 'b':  c = '\b'; break;
+                    case 'e':  c = 0x1B; break;
+                    case '\\': c = '\\'; break;
+                    default:   return false;
+                }
+            }
+            ascii_key_t k = ascii_key(c);
+            if (!k.code)
+                return false;
+            if (k.shift)
+                add_event(in, cycle, false, PS2_LSHIFT);
+            add_event(in, cycle, false, k.code);
+            add_event(in, cycle, false, PS2_BREAK);
+            add_event(in, cycle, false, k.code);
+            if (k.shift) {
+                add_event(in, cycle, false, PS2_BREAK);
+                add_event(in, cycle, false, PS2_LSHIFT);
+            }
+        }
+        return true;
+    } else if (cmd_len == 5 && !strncmp(cmd, "mouse", 5)) {
+        int btn, dx, dy, dz;
+        int n;
+        if (sscanf(p, "%i %i %i %i %n", &btn, &dx, &dy, &dz, &n) != 4 || p[n] != '\0')
+            return false;
+        if (btn < 0 || btn > 7 || dx < -128 || dx > 127 || dy < -128 || dy > 127 || dz < -128 || dz > 127)
+            return false;
+        add_event(in, cycle, true, mouse_word(btn, dx, dy, dz));
+        return true;
+    }
+
+    return false;
+}
+
+bool sim_input_open(sim_input_t *in, const char *script_path, const char *record_path, int gap)
+{
+    *in = sim_input_t();
+    in->gap = std::max(gap, 1);
+
+    if (script_path) {
+        FILE *f = fopen(script_path, "r");
+        if (!f) {
+            perror(script_path);
+            return false;
+        }
+        char line[1024];
+        int line_no = 0;
+        uint64_t last_cycle = 0;
+        while (fgets(line, sizeof(line), f)) {
+            ++line_no;
+            if (!parse_line(in, line, &last_cycle)) {
+                fprintf(stderr, "%s:%d: invalid input event\n", script_path, line_no);
+                fclose(f);
+                return false;
+            }
+        }
+        fclose(f);
+    }
+
+    if (record_path) {
+        in->record = fopen(record_path, "w");
+        if (!in->record) {
+            perror(record_path);
+            return false;
+        }
+        fprintf(in->record, "# cycle kbd <codes> | cycle mouse <btn> <dx> <dy> <dz>\n");
+    }
+
+    return true;
+}
+
+void sim_input_kbd(sim_input_t *in, const uint8_t *codes, int n)
+{
+    if (n <= 0)
+        return;
+
+    in->kbd_queue.insert(in->kbd_queue.end(), codes, codes + n);
+
+    if (in->record) {
+        // Queued now, seen by the next posedge
+        fprintf(in->record, "%" PRIu64 " kbd", in->cycles + 1);
+        for (int i = 0; i < n; ++i)
+            fprintf(in->record, " %02x", codes[i]);
+        fprintf(in->record, "\n");
+    }
+}
+
+void sim_input_mouse(sim_input_t *in, int btn, int dx, int dy, int dz)
+{
+    dx = std::min(std::max(dx, -128), 127);
+    dy = std::min(std::max(dy, -128), 127);
+    dz = std::min(std::max(dz, -128), 127);
+
+    in->mouse_queue.push_back(mouse_word(btn, dx, dy, dz));
+
+    if (in->record)
+        fprintf(in->record, "%" PRIu64 " mouse %d %d %d %d\n", in->cycles + 1, btn & 0x7, dx, dy, dz);
+}
+
+void sim_input_posedge(sim_input_t *in, uint64_t cycles, Vtop *top)
+{
+    in->cycles = cycles;
+
+    while (in->next < in->script.size() && in->script[in->next].cycle <= cycles) {
+        const sim_input_event_t &e = in->script[in->next++];
+        if (e.mouse)
+            in->mouse_queue.push_back(e.data);
+        else
+            in->kbd_queue.push_back((uint8_t)e.data);
+    }
+
+    // One strobe per code, at most every <gap> cycles to let the
+    // firmware drain the 16-entry FIFOs
+    top->ps2_kbd_strobe_i = 0;
+    if (!in->kbd_queue.empty() && cycles >= in->kbd_ready) {
+        top->ps2_kbd_code_i = in->kbd_queue.front();
+        top->ps2_kbd_strobe_i = 1;
+        in->kbd_queue.pop_front();
+        in->kbd_ready = cycles + in->gap;
+    }
+
+    top->ps2_mouse_strobe_i = 0;
+    if (!in->mouse_queue.empty() && cycles >= in->mouse_ready) {
+        top->ps2_mouse_data_i = in->mouse_queue.front();
+        top->ps2_mouse_strobe_i = 1;
+        in->mouse_queue.pop_front();
+        in->mouse_ready = cycles + in->gap;
+    }
+}
+
+// The recorded cycles must increase, a snapshot restore or a reset ends the recording
+static void stop_recording(sim_input_t *in)
+{
+    if (in->record) {
+        fclose(in->record);
+        in->record = nullptr;
+        printf("Input recording stopped\n");
+    }
+}
+
+void sim_input_save(const sim_input_t *in, sim_input_state_t *state, std::vector<uint8_t> *queues)
+{
+    state->kbd_ready = in->kbd_ready;
+    state->mouse_ready = in->mouse_ready;
+    state->kbd_len = (uint32_t)in->kbd_queue.size();
+    state->mouse_len = (uint32_t)in->mouse_queue.size();
+    queues->insert(queues->end(), in->kbd_queue.begin(), in->kbd_queue.end());
+    for (uint32_t data : in->mouse_queue) {
+        const uint8_t *p = (const uint8_t *)&data;
+        queues->insert(queues->end(), p, p + sizeof(data));
+    }
+}
+
+bool sim_input_restore(sim_input_t *in, const sim_input_state_t *state,
+                       const uint8_t *queues, size_t queues_size, uint64_t cycles)
+{
+    if (queues_size != state->kbd_len + (size_t)state->mouse_len * sizeof(uint32_t))
+        return false;
+
+    in->cycles = cycles;
+    in->kbd_ready = state->kbd_ready;
+    in->mouse_ready = state->mouse_ready;
+    in->kbd_queue.assign(queues, queues + state->kbd_len);
+    in->mouse_queue.resize(state->mouse_len);
+    for (uint32_t i = 0; i < state->mouse_len; ++i)
+        memcpy(&in->mouse_queue[i], queues + state->kbd_len + i * sizeof(uint32_t), sizeof(uint32_t));
+
+    // Events up to <cycles> are already in the snapshot
+    in->next = 0;
+    while (in->next < in->script.size() && in->script[in->next].cycle <= cycles)
+        in->next++;
+
+    stop_recording(in);
+
+    return true;
+}
+
+void sim_input_reset(sim_input_t *in)
+{
+    in->next = 0;
+    in->cycles = 0;
+    in->kbd_ready = 0;
+    in->mouse_ready = 0;
+    in->kbd_queue.clear();
+    in->mouse_queue.clear();
+
+    stop_recording(in);
+}
+
+void sim_input_close(sim_input_t *in)
+{
+    if (in->record) {
+        fclose(in->record);
+        in->record = nullptr;
+    }
+}
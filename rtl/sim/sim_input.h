@@ -0,0 +1,82 @@
+// sim_input.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// PS/2 keyboard and mouse input of a model built with PS2_SIM. The input
+// comes from the host (SDL) and/or from a script of timed events, keyed on
+// CPU cycles so that a replay is reproducible. The host input can be recorded
+// in the same format:
+//
+//   # comment
+//   <cycle> kbd <byte> ...                 raw PS/2 set 2 codes, in hex
+//   <cycle> type <text>                    make/break codes of the text,
+//                                          with \n, \t, \b, \e and \\ escapes
+//   <cycle> mouse <btn> <dx> <dy> <dz>     btn: bit 0 left, 1 right, 2 middle
+//
+// <cycle> is absolute, or relative to the previous event when prefixed by '+'.
+
+#ifndef SIM_INPUT_H
+#define SIM_INPUT_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <deque>
+#include <vector>
+
+#include "Vtop.h"
+
+struct sim_input_event_t {
+    uint64_t cycle;             // queued before the posedge of this cycle
+    bool mouse;
+    uint32_t data;              // keyboard code, or {btn, dx, dy, dz}
+};
+
+struct sim_input_t {
+    std::vector<sim_input_event_t> script;
+    size_t next;                // next script event
+
+    int gap;                    // minimum CPU cycles between two strobes
+    uint64_t cycles;            // last posedge
+    uint64_t kbd_ready;         // cycle of the next possible keyboard strobe
+    uint64_t mouse_ready;
+    std::deque<uint8_t> kbd_queue;
+    std::deque<uint32_t> mouse_queue;
+
+    FILE *record;
+};
+
+// Pending input, saved in a snapshot; the queues follow as kbd_len keyboard
+// codes and mouse_len mouse words
+struct sim_input_state_t {
+    uint64_t kbd_ready;
+    uint64_t mouse_ready;
+    uint32_t kbd_len;
+    uint32_t mouse_len;
+};
+
+// Returns false if the script cannot be parsed or the record file cannot be
+// created; both paths are optional
+bool sim_input_open(sim_input_t *in, const char *script_path, const char *record_path, int gap);
+
+// Host input, recorded if requested
+void sim_input_kbd(sim_input_t *in, const uint8_t *codes, int n);
+void sim_input_mouse(sim_input_t *in, int btn, int dx, int dy, int dz);
+
+// To be called before evaluating each positive edge of clk
+void sim_input_posedge(sim_input_t *in, uint64_t cycles, Vtop *top);
+
+// Appends the full pending queues to <queues>
+void sim_input_save(const sim_input_t *in, sim_input_state_t *state, std::vector<uint8_t> *queues);
+
+// Also skips the script events before <cycles>. Returns false if the
+// <queues_size> bytes at <queues> do not match the saved queue lengths
+bool sim_input_restore(sim_input_t *in, const sim_input_state_t *state,
+                       const uint8_t *queues, size_t queues_size, uint64_t cycles);
+
+// Rewinds the script and drops the pending input, for a new model
+void sim_input_reset(sim_input_t *in);
+
+void sim_input_close(sim_input_t *in);
+
+#endif  // SIM_INPUT_H
@@ -0,0 +1,666 @@
+// sim_iss.cpp
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+#include "sim_iss.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "Vtop___024root.h"
+#include "sim_elf.h"
+#include "sim_rtl.h"
+
+// soc_top parameters of the simulation build (FREQ_HZ, VIDEO_QVGA)
+#define CYCLES_PER_MS   (CPU_FREQ_HZ / 1000)
+#define H_RES           320
+#define V_RES           240
+#define FRAME_CYCLES    (800 * 525)
+#define VSYNC_CYCLES    (800 * 2)
+#define HW_CONF         0x80000017  // simulation, Graphite, mouse, keyboard, video
+#define DEFAULT_FB_ADDRESS 0x1000000
+
+// Cycles between two polls of the host UART
+#define UART_POLL_CYCLES 65536
+
+#define BASE_IO         0xE0000000
+
+void sim_iss_init(sim_iss_t *s, uint16_t *mem, size_t size, sim_uart_t *uart, uint32_t pc, int exit_led)
+{
+    memset(s, 0, sizeof(*s));
+    s->mem = (uint8_t *)mem;
+    s->size = size;
+    s->uart = uart;
+    s->pc = pc;
+    s->fb_addr = DEFAULT_FB_ADDRESS;
+    s->exit_led = exit_led;
+}
+
+static void fail(sim_iss_t *s, const char *what, uint32_t value)
+{
+    fprintf(stderr, "Fast-forward: %s 0x%08x at PC 0x%08x\n", what, value, s->pc);
+    s->reason = SIM_ISS_ERROR;
+    s->stop = true;
+}
+
+static uint32_t io_read(sim_iss_t *s, uint32_t addr)
+{
+    switch ((addr >> 2) & 31) {
+        case 0:     // TIMER
+            return (uint32_t)(s->cycles / CYCLES_PER_MS);
+        case 2: {   // UART_DATA
+            if (s->uart->rx_queue.empty())
+                return 0;
+            uint8_t c = s->uart->rx_queue.front();
+            s->uart->rx_queue.pop_front();
+            return c;
+        }
+        case 3:     // UART_STATUS: transmitter always ready
+            return 2 | (s->uart->rx_queue.empty() ? 0 : 1);
+        case 8:     // Graphite ready
+            return 1;
+        case 9:     // CONFIG: resolution
+            return H_RES << 16 | V_RES;
+        case 10:
+            return s->fb_addr;
+        case 11:
+            return (s->cycles % FRAME_CYCLES) < VSYNC_CYCLES;
+        case 14:    // CONFIG4
+            return HW_CONF;
+    }
+    return 0;
+}
+
+static void io_write(sim_iss_t *s, uint32_t addr, uint32_t value)
+{
+    switch ((addr >> 2) & 31) {
+        case 1:     // LED
+            s->led = (uint8_t)value;
+            if (s->exit_led >= 0 && s->led == s->exit_led) {
+                s->reason = SIM_ISS_EXIT_LED;
+                s->stop = true;
+            }
+            break;
+        case 2:     // UART_DATA
+            if (s->uart->mode != SIM_UART_NONE)
+                s->uart->tx_buf += (char)value;
+            break;
+        case 10:
+            s->fb_addr = value;
+            break;
+    }
+}
+
+static inline bool in_mem(sim_iss_t *s, uint32_t addr, uint32_t len)
+{
+    return addr < s->size && len <= s->size - addr;
+}
+
+static uint32_t load(sim_iss_t *s, uint32_t addr, int len)
+{
+    if (in_mem(s, addr, len)) {
+        uint32_t v = 0;
+        memcpy(&v, s->mem + addr, len);    // little-endian host
+        return v;
+    }
+    if ((addr >> 28) == (BASE_IO >> 28))
+        return io_read(s, addr);
+    if ((addr >> 28) == 1)
+        return 0;   // VDU
+    fail(s, "load from", addr);
+    return 0;
+}
+
+static void store(sim_iss_t *s, uint32_t addr, uint32_t value, int len)
+{
+    if (in_mem(s, addr, len))
+        memcpy(s->mem + addr, &value, len);
+    else if ((addr >> 28) == (BASE_IO >> 28))
+        io_write(s, addr, value);
+    else if ((addr >> 28) != 1)     // VDU ignored
+        fail(s, "store to", addr);
+}
+
+/*****************************************************************************/
+// Compressed instructions, expanded to their 32-bit equivalent
+/*****************************************************************************/
+
+static inline uint32_t enc_r(uint32_t op, uint32_t rd, uint32_t f3, uint32_t rs1, uint32_t rs2, uint32_t f7)
+{
+    return f7 << 25 | rs2 << 20 | rs1 << 15 | f3 << 12 | rd << 7 | op;
+}
+
+static inline uint32_t enc_i(uint32_t op, uint32_t rd, uint32_t f3, uint32_t rs1, int32_t imm)
+{
+    return (uint32_t)imm << 20 | rs1 << 15 | f3 << 12 | rd << 7 | op;
+}
+
+static inline uint32_t enc_s(uint32_t op, uint32_t f3, uint32_t rs1, uint32_t rs2, int32_t imm)
+{
+    return ((uint32_t)imm >> 5 & 0x7f) << 25 | rs2 << 20 | rs1 << 15 | f3 << 12 | (imm & 0x1f) << 7 | op;
+}
+
+static inline uint32_t enc_b(uint32_t f3, uint32_t rs1, uint32_t rs2, int32_t imm)
+{
+    uint32_t i = (uint32_t)imm;
+    return (i >> 12 & 1) << 31 | (i >> 5 & 0x3f) << 25 | rs2 << 20 | rs1 << 15 | f3 << 12 |
+           (i >> 1 & 0xf) << 8 | (i >> 11 & 1) << 7 | 0x63;
+}
+
+static inline uint32_t enc_j(uint32_t rd, int32_t imm)
+{
+    uint32_t i = (uint32_t)imm;
+    return (i >> 20 & 1) << 31 | (i >> 1 & 0x3ff) << 21 | (i >> 11 & 1) << 20 | (i >> 12 & 0xff) << 12 |
+           rd << 7 | 0x6f;
+}
+
+static inline uint32_t bit(uint32_t c, int from, int to = 0)
+{
+    return (c >> from & 1) << to;
+}
+
+static inline int32_t sext(uint32_t v, int bits)
+{
+    return (int32_t)(v << (32 - bits)) >> (32 - bits);
+}
+
+// Returns 0 if illegal
+static uint32_t expand(uint32_t c)
+{
+    uint32_t rd = c >> 7 & 31;
+    uint32_t rs2 = c >> 2 & 31;
+    uint32_t rdp = (c >> 2 & 7) + 8;     // rd', rs2'
+    uint32_t rs1p = (c >> 7 & 7) + 8;    // rs1', rd'
+    int32_t imm6 = sext(bit(c, 12, 5) | (c >> 2 & 31), 6);
+
+    switch ((c >> 13) << 2 | (c & 3)) {
+        // Quadrant 0
+        case 0x00: {    // C.ADDI4SPN
+            uint32_t imm = (c >> 11 & 3) << 4 | (c >> 7 & 15) << 6 | bit(c, 6, 2) | bit(c, 5, 3);
+            return imm ? enc_i(0x13, rdp, 0, 2, imm) : 0;
+        }
+        case 0x08:      // C.LW
+        case 0x0c: {    // C.FLW
+            uint32_t imm = (c >> 10 & 7) << 3 | bit(c, 6, 2) | bit(c, 5, 6);
+            return enc_i((c >> 13) == 2 ? 0x03 : 0x07, rdp, 2, rs1p, imm);
+        }
+        case 0x18:      // C.SW
+        case 0x1c: {    // C.FSW
+            uint32_t imm = (c >> 10 & 7) << 3 | bit(c, 6, 2) | bit(c, 5, 6);
+            return enc_s((c >> 13) == 6 ? 0x23 : 0x27, 2, rs1p, rdp, imm);
+        }
+
+        // Quadrant 1
+        case 0x01:      // C.ADDI
+            return enc_i(0x13, rd, 0, rd, imm6);
+        case 0x05:      // C.JAL
+        case 0x15: {    // C.J
+            uint32_t imm = bit(c, 12, 11) | bit(c, 11, 4) | (c >> 9 & 3) << 8 | bit(c, 8, 10) | bit(c, 7, 6) |
+                           bit(c, 6, 7) | (c >> 3 & 7) << 1 | bit(c, 2, 5);
+            return enc_j((c >> 13) == 1 ? 1 : 0, sext(imm, 12));
+        }
+        case 0x09:      // C.LI
+            return enc_i(0x13, rd, 0, 0, imm6);
+        case 0x0d:
+            if (rd == 2) {  // C.ADDI16SP
+                uint32_t imm = bit(c, 12, 9) | bit(c, 6, 4) | bit(c, 5, 6) | (c >> 3 & 3) << 7 | bit(c, 2, 5);
+                return imm ? enc_i(0x13, 2, 0, 2, sext(imm, 10)) : 0;
+            }
+            // C.LUI
+            return imm6 ? ((uint32_t)imm6 << 12 | rd << 7 | 0x37) : 0;
+        case 0x11:
+            switch (c >> 10 & 3) {
+                case 0:     // C.SRLI
+                    return enc_r(0x13, rs1p, 5, rs1p, c >> 2 & 31, 0);
+                case 1:     // C.SRAI
+                    return enc_r(0x13, rs1p, 5, rs1p, c >> 2 & 31, 0x20);
+                case 2:     // C.ANDI
+                    return enc_i(0x13, rs1p, 7, rs1p, imm6);
+                default:
+                    if (c & (1 << 12))
+                        return 0;
+                    switch (c >> 5 & 3) {
+                        case 0: return enc_r(0x33, rs1p, 0, rs1p, rdp, 0x20);  // C.SUB
+                        case 1: return enc_r(0x33, rs1p, 4, rs1p, rdp, 0);     // C.XOR
+                        case 2: return enc_r(0x33, rs1p, 6, rs1p, rdp, 0);     // C.OR
+                        default: return enc_r(0x33, rs1p, 7, rs1p, rdp, 0);    // C.AND
+                    }
+            }
+        case 0x19:      // C.BEQZ
+        case 0x1d: {    // C.BNEZ
+            uint32_t imm = bit(c, 12, 8) | (c >> 10 & 3) << 3 | (c >> 5 & 3) << 6 | (c >> 3 & 3) << 1 | bit(c, 2, 5);
+            return enc_b((c >> 13) == 6 ? 0 : 1, rs1p, 0, sext(imm, 9));
+        }
+
+        // Quadrant 2
+        case 0x02:      // C.SLLI
+            return enc_r(0x13, rd, 1, rd, c >> 2 & 31, 0);
+        case 0x0a:      // C.LWSP
+        case 0x0e: {    // C.FLWSP
+            uint32_t imm = bit(c, 12, 5) | (c >> 4 & 7) << 2 | (c >> 2 & 3) << 6;
+            return enc_i((c >> 13) == 2 ? 0x03 : 0x07, rd, 2, 2, imm);
+        }
+        case 0x12:
+            if (!(c & (1 << 12))) {
+                if (!rs2)   // C.JR
+                    return rd ? enc_i(0x67, 0, 0, rd, 0) : 0;
+                return enc_r(0x33, rd, 0, 0, rs2, 0);       // C.MV
+            }
+            if (!rs2) {
+                if (!rd)    // C.EBREAK
+                    return 0x00100073;
+                return enc_i(0x67, 1, 0, rd, 0);            // C.JALR
+            }
+            return enc_r(0x33, rd, 0, rd, rs2, 0);          // C.ADD
+        case 0x1a:      // C.SWSP
+        case 0x1e: {    // C.FSWSP
+            uint32_t imm = (c >> 9 & 15) << 2 | (c >> 7 & 3) << 6;
+            return enc_s((c >> 13) == 6 ? 0x23 : 0x27, 2, 2, rs2, imm);
+        }
+    }
+    return 0;
+}
+
+/*****************************************************************************/
+// Execution
+/*****************************************************************************/
+
+static inline float to_float(uint32_t v)
+{
+    float f;
+    memcpy(&f, &v, sizeof(f));
+    return f;
+}
+
+static inline uint32_t from_float(float f)
+{
+    uint32_t v;
+    memcpy(&v, &f, sizeof(v));
+    return v;
+}
+
+static uint32_t fclass(uint32_t v)
+{
+    bool sign = v >> 31;
+    uint32_t exp = v >> 23 & 0xff;
+    uint32_t frac = v & 0x7fffff;
+    if (exp == 0xff) {
+        if (!frac)
+            return sign ? 1 << 0 : 1 << 7;
+        return frac & 0x400000 ? 1 << 9 : 1 << 8;
+    }
+    if (exp == 0)
+        return frac ? (sign ? 1 << 2 : 1 << 5) : (sign ? 1 << 3 : 1 << 4);
+    return sign ? 1 << 1 : 1 << 6;
+}
+
+static float round_rm(float f, uint32_t rm)
+{
+    switch (rm) {
+        case 1: return truncf(f);
+        case 2: return floorf(f);
+        case 3: return ceilf(f);
+        case 4: return roundf(f);
+        default: return nearbyintf(f);  // RNE, also for the dynamic mode (no fcsr)
+    }
+}
+
+static uint32_t fcvt_w(float f, uint32_t rm, bool is_unsigned)
+{
+    if (std::isnan(f))
+        return is_unsigned ? 0xffffffff : 0x7fffffff;
+    double r = round_rm(f, rm);
+    if (is_unsigned)
+        return r <= 0.0 ? 0 : r >= 4294967295.0 ? 0xffffffff : (uint32_t)r;
+    return r <= -2147483648.0 ? 0x80000000 : r >= 2147483647.0 ? 0x7fffffff : (uint32_t)(int32_t)r;
+}
+
+static uint32_t fminmax(uint32_t a, uint32_t b, bool max)
+{
+    float fa = to_float(a), fb = to_float(b);
+    if (std::isnan(fa) && std::isnan(fb))
+        return 0x7fc00000;
+    if (std::isnan(fa))
+        return b;
+    if (std::isnan(fb))
+        return a;
+    if (fa == fb)   // -0 < +0
+        return max ? (a & b) : (a | b);
+    return (max ? fa > fb : fa < fb) ? a : b;
+}
+
+static int32_t sat(int64_t v, int bits)
+{
+    int64_t max = ((int64_t)1 << (bits - 1)) - 1;
+    return v > max ? max : v < -max - 1 ? -max - 1 : v;
+}
+
+// Packed SIMD lane (custom-0, see processor.v), except the multiplications
+static uint16_t simd_lane(uint16_t a, uint16_t b, uint32_t f3, uint32_t f7, uint32_t imm)
+{
+    bool sub = f7 & 0x20;
+    int32_t sa = (int16_t)a, sb = (int16_t)b;
+    int32_t smax = (1 << imm) - 1;
+    switch (f3) {
+        case 0: return sub ? a - b : a + b;
+        case 1: return sat(sub ? sa - sb : sa + sb, 16);
+        case 2: {
+            int32_t r = sub ? a - b : a + b;
+            return r < 0 ? 0 : r > 0xffff ? 0xffff : r;
+        }
+        case 6:
+            if (sub)
+                return sa < 0 ? 0 : sa > smax ? smax : sa;
+            return sa < -smax - 1 ? -smax - 1 : sa > smax ? smax : sa;
+        default:
+            return f7 & 0x40 ? a << imm : sub ? (uint16_t)(sa >> imm) : a >> imm;
+    }
+}
+
+static uint32_t simd(uint32_t instr, uint32_t a, uint32_t b, uint32_t c)
+{
+    uint32_t f3 = instr >> 12 & 7;
+    uint32_t f7 = instr >> 25;
+    int32_t p0 = (int16_t)a * (int16_t)b;
+    int32_t p1 = (int16_t)(a >> 16) * (int16_t)(b >> 16);
+    switch (f3) {
+        case 3: return (uint16_t)sat(p1 >> 15, 16) << 16 | (uint16_t)sat(p0 >> 15, 16);
+        case 4: return (uint32_t)p1 << 16 | (uint16_t)p0;
+        case 5: return sat((int64_t)(int32_t)c + p0 + p1, 32);
+    }
+    uint32_t imm = instr >> 20 & 15;
+    return (uint32_t)simd_lane(a >> 16, b >> 16, f3, f7, imm) << 16 | simd_lane(a, b, f3, f7, imm);
+}
+
+static uint32_t csr_read(sim_iss_t *s, uint32_t csr)
+{
+    switch (csr) {
+        case 0x300: return s->mstatus & 8;
+        case 0x305: return s->mtvec;
+        case 0x341: return s->mepc;
+        // One instruction per cycle, the other counters stay at 0
+        case 0xC00: case 0xB00:
+        case 0xC02: case 0xB02: return (uint32_t)s->cycles;
+        case 0xC80: case 0xB80:
+        case 0xC82: case 0xB82: return (uint32_t)(s->cycles >> 32);
+    }
+    return 0;
+}
+
+static void step(sim_iss_t *s)
+{
+    uint32_t pc = s->pc;
+    if (!in_mem(s, pc, 2)) {
+        fail(s, "fetch from", pc);
+        return;
+    }
+    uint32_t instr = s->mem[pc] | s->mem[pc + 1] << 8;
+    uint32_t next = pc + 2;
+    if ((instr & 3) == 3) {
+        if (!in_mem(s, pc, 4)) {
+            fail(s, "fetch from", pc);
+            return;
+        }
+        instr |= (uint32_t)(s->mem[pc + 2] | s->mem[pc + 3] << 8) << 16;
+        next = pc + 4;
+    } else if (!(instr = expand(instr))) {
+        fail(s, "illegal instruction", s->mem[pc] | s->mem[pc + 1] << 8);
+        return;
+    }
+
+    uint32_t *x = s->x;
+    uint32_t *f = s->f;
+    uint32_t rd = instr >> 7 & 31;
+    uint32_t rs1 = instr >> 15 & 31;
+    uint32_t rs2 = instr >> 20 & 31;
+    uint32_t f3 = instr >> 12 & 7;
+    uint32_t f7 = instr >> 25;
+    int32_t imm_i = (int32_t)instr >> 20;
+    int32_t imm_s = ((int32_t)instr >> 25) << 5 | (instr >> 7 & 31);
+    uint32_t a = x[rs1];
+    uint32_t b = x[rs2];
+    uint32_t result = 0;
+    bool write = true;
+
+    switch (instr & 0x7f) {
+        case 0x37:  // LUI
+            result = instr & 0xfffff000;
+            break;
+        case 0x17:  // AUIPC
+            result = pc + (instr & 0xfffff000);
+            break;
+        case 0x6f: {    // JAL
+            int32_t imm = sext(bit(instr, 31, 20) | (instr >> 21 & 0x3ff) << 1 | bit(instr, 20, 11) |
+                               (instr & 0xff000), 21);
+            result = next;
+            next = pc + imm;
+            break;
+        }
+        case 0x67:  // JALR
+            result = next;
+            next = (a + imm_i) & ~1u;
+            break;
+        case 0x63: {    // Branches
+            int32_t imm = sext(bit(instr, 31, 12) | (instr >> 25 & 0x3f) << 5 | (instr >> 8 & 15) << 1 |
+                               bit(instr, 7, 11), 13);
+            bool taken;
+            switch (f3) {
+                case 0: taken = a == b; break;
+                case 1: taken = a != b; break;
+                case 4: taken = (int32_t)a < (int32_t)b; break;
+                case 5: taken = (int32_t)a >= (int32_t)b; break;
+                case 6: taken = a < b; break;
+                case 7: taken = a >= b; break;
+                default: fail(s, "illegal instruction", instr); return;
+            }
+            if (taken)
+                next = pc + imm;
+            write = false;
+            break;
+        }
+        case 0x03: {    // Loads
+            uint32_t addr = a + imm_i;
+            switch (f3) {
+                case 0: result = (int32_t)(int8_t)load(s, addr, 1); break;
+                case 1: result = (int32_t)(int16_t)load(s, addr, 2); break;
+                case 2: result = load(s, addr, 4); break;
+                case 4: result = load(s, addr, 1); break;
+                case 5: result = load(s, addr, 2); break;
+                default: fail(s, "illegal instruction", instr); return;
+            }
+            break;
+        }
+        case 0x23:  // Stores
+            if (f3 > 2) {
+                fail(s, "illegal instruction", instr);
+                return;
+            }
+            store(s, a + imm_s, b, 1 << f3);
+            write = false;
+            break;
+        case 0x13: {    // ALU immediate
+            uint32_t shamt = instr >> 20 & 31;
+            switch (f3) {
+                case 0: result = a + imm_i; break;
+                case 1: result = a << shamt; break;
+                case 2: result = (int32_t)a < imm_i; break;
+                case 3: result = a < (uint32_t)imm_i; break;
+                case 4: result = a ^ imm_i; break;
+                case 5: result = f7 & 0x20 ? (uint32_t)((int32_t)a >> shamt) : a >> shamt; break;
+                case 6: result = a | imm_i; break;
+                case 7: result = a & imm_i; break;
+            }
+            break;
+        }
+        case 0x33:  // ALU
+            if (f7 == 1) {  // M extension
+                switch (f3) {
+                    case 0: result = a * b; break;
+                    case 1: result = (uint32_t)(((int64_t)(int32_t)a * (int32_t)b) >> 32); break;
+                    case 2: result = (uint32_t)(((int64_t)(int32_t)a * (uint64_t)b) >> 32); break;
+                    case 3: result = (uint32_t)(((uint64_t)a * b) >> 32); break;
+                    case 4:
+                        result = !b ? 0xffffffff : (a == 0x80000000 && b == 0xffffffff) ? a
+                               : (uint32_t)((int32_t)a / (int32_t)b);
+                        break;
+                    case 5: result = b ? a / b : 0xffffffff; break;
+                    case 6:
+                        result = !b ? a : (a == 0x80000000 && b == 0xffffffff) ? 0
+                               : (uint32_t)((int32_t)a % (int32_t)b);
+                        break;
+                    case 7: result = b ? a % b : a; break;
+                }
+                break;
+            }
+            switch (f3) {
+                case 0: result = f7 & 0x20 ? a - b : a + b; break;
+                case 1: result = a << (b & 31); break;
+                case 2: result = (int32_t)a < (int32_t)b; break;
+                case 3: result = a < b; break;
+                case 4: result = a ^ b; break;
+                case 5: result = f7 & 0x20 ? (uint32_t)((int32_t)a >> (b & 31)) : a >> (b & 31); break;
+                case 6: result = a | b; break;
+                case 7: result = a & b; break;
+            }
+            break;
+        case 0x0b:  // custom-0: packed SIMD
+            result = simd(instr, a, b, x[instr >> 27]);
+            break;
+        case 0x0f:  // FENCE
+            write = false;
+            break;
+        case 0x73:  // SYSTEM
+            if (f3 == 0) {
+                // As in the processor, any of them returns from interrupt
+                next = s->mepc;
+                write = false;
+                break;
+            }
+            {
+                uint32_t csr = instr >> 20;
+                uint32_t old = csr_read(s, csr);
+                uint32_t mod = f3 & 4 ? rs1 : a;
+                uint32_t value = (f3 & 3) == 1 ? mod : (f3 & 3) == 2 ? old | mod : old & ~mod;
+                if (csr == 0x300)
+                    s->mstatus = value & 8;
+                else if (csr == 0x305)
+                    s->mtvec = value;
+                result = old;
+            }
+            break;
+
+        // F extension
+        case 0x07:  // FLW
+            if (f3 != 2) {
+                fail(s, "illegal instruction", instr);
+                return;
+            }
+            f[rd] = load(s, a + imm_i, 4);
+            write = false;
+            break;
+        case 0x27:  // FSW
+            if (f3 != 2) {
+                fail(s, "illegal instruction", instr);
+                return;
+            }
+            store(s, a + imm_s, f[rs2], 4);
+            write = false;
+            break;
+        case 0x43:  // FMADD
+        case 0x47:  // FMSUB
+        case 0x4b:  // FNMSUB
+        case 0x4f: {    // FNMADD
+            float fa = to_float(f[rs1]), fb = to_float(f[rs2]), fc = to_float(f[instr >> 27]);
+            uint32_t op = instr >> 2 & 3;
+            if (op & 2)
+                fa = -fa;
+            if (op == 1 || op == 3)
+                fc = -fc;
+            f[rd] = from_float(fmaf(fa, fb, fc));
+            write = false;
+            break;
+        }
+        case 0x53: {    // OP-FP
+            float fa = to_float(f[rs1]), fb = to_float(f[rs2]);
+            write = false;
+            switch (f7) {
+                case 0x00: f[rd] = from_float(fa + fb); break;
+                case 0x04: f[rd] = from_float(fa - fb); break;
+                case 0x08: f[rd] = from_float(fa * fb); break;
+                case 0x0c: f[rd] = from_float(fa / fb); break;
+                case 0x2c: f[rd] = from_float(sqrtf(fa)); break;
+                case 0x10: {    // FSGNJ, FSGNJN, FSGNJX
+                    uint32_t sign = f3 == 0 ? f[rs2] : f3 == 1 ? ~f[rs2] : f[rs1] ^ f[rs2];
+                    f[rd] = (f[rs1] & 0x7fffffff) | (sign & 0x80000000);
+                    break;
+                }
+                case 0x14: f[rd] = fminmax(f[rs1], f[rs2], f3 == 1); break;
+                case 0x60: result = fcvt_w(fa, f3, rs2 == 1); write = true; break;
+                case 0x68: f[rd] = from_float(rs2 == 1 ? (float)a : (float)(int32_t)a); break;
+                case 0x70: result = f3 == 1 ? fclass(f[rs1]) : f[rs1]; write = true; break;
+                case 0x78: f[rd] = a; break;
+                case 0x50:
+                    result = f3 == 2 ? fa == fb : f3 == 1 ? fa < fb : fa <= fb;
+                    write = true;
+                    break;
+                default: fail(s, "illegal instruction", instr); return;
+            }
+            break;
+        }
+        default:
+            fail(s, "illegal instruction", instr);
+            return;
+    }
+
+    if (write && rd)
+        x[rd] = result;
+    s->pc = next;
+    s->cycles++;
+}
+
+sim_iss_stop_t sim_iss_run(sim_iss_t *s, uint32_t marker, uint64_t max_cycles)
+{
+    s->stop = false;
+    while (s->pc != marker) {
+        if (max_cycles && s->cycles >= max_cycles)
+            return SIM_ISS_BUDGET;
+        step(s);
+        if (s->stop)
+            return s->reason;
+        if (s->cycles % UART_POLL_CYCLES == 0)
+            sim_uart_poll(s->uart);
+    }
+    sim_uart_poll(s->uart);
+    return SIM_ISS_MARKER;
+}
+
+bool sim_iss_find_symbol(const char *elf_path, const char *name, uint32_t *addr)
+{
+    bool found = false;
+    size_t len = strlen(name);
+    elf_for_each_symbol(elf_path, [&](const elf32_sym &sym, const char *s, size_t s_len) {
+        if (s_len != len || memcmp(s, name, len))
+            return true;
+        *addr = sym.st_value & ~1u;
+        found = true;
+        return false;
+    });
+    return found;
+}
+
+void sim_iss_handoff(sim_iss_t *s, Vtop *top)
+{
+    Vtop___024root *r = top->rootp;
+    for (int i = 1; i < 32; ++i)
+        r->top__DOT__soc_top__DOT__processor__DOT__registerFile[i] = s->x[i];
+    for (int i = 0; i < 32; ++i)
+        r->top__DOT__soc_top__DOT__processor__DOT__registerFile[32 + i] = s->f[i];
+    r->top__DOT__soc_top__DOT__processor__DOT__PC = s->pc;
+    r->top__DOT__soc_top__DOT__processor__DOT__cycles = s->cycles;
+    r->top__DOT__soc_top__DOT__processor__DOT__instret = s->cycles;
+    r->top__DOT__soc_top__DOT__cnt0 = s->cycles % CYCLES_PER_MS;
+    r->top__DOT__soc_top__DOT__cnt1 = (uint32_t)(s->cycles / CYCLES_PER_MS);
+    r->top__DOT__soc_top__DOT__fb_addr = s->fb_addr;
+}
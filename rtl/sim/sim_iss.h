@@ -0,0 +1,72 @@
+// sim_iss.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// Instruction-set model of the RV32IMFC processor, used to fast-forward a
+// program to a marker PC before the RTL takes over. It runs on the SDRAM
+// array and the soc_top MMIO map: timer, LED, UART (through sim_uart),
+// CONFIG registers and frame buffer address. The SD card, keyboard, mouse,
+// USB and Graphite are not modeled (reads return 0, writes are ignored).
+//
+// One instruction takes one cycle: the timer and the cycle counter advance
+// accordingly. The floating-point results are those of the host, which may
+// differ from the processor FPU in the last bit (division, square root).
+//
+// The architectural state (integer and floating-point registers, PC, cycle
+// counter, timer, frame buffer address) is written to the model once the
+// processor is out of reset, before its first instruction fetch.
+
+#ifndef SIM_ISS_H
+#define SIM_ISS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Vtop.h"
+#include "sim_uart.h"
+
+enum sim_iss_stop_t {
+    SIM_ISS_MARKER,             // PC reached the marker
+    SIM_ISS_EXIT_LED,           // exit sentinel written to the LED register
+    SIM_ISS_BUDGET,             // cycle budget reached
+    SIM_ISS_ERROR               // illegal instruction or access
+};
+
+struct sim_iss_t {
+    uint8_t *mem;
+    size_t size;
+    sim_uart_t *uart;
+
+    uint32_t x[32];
+    uint32_t f[32];             // single-precision bits
+    uint32_t pc;
+    uint64_t cycles;            // = instructions
+
+    // CSRs
+    uint32_t mstatus;
+    uint32_t mtvec;
+    uint32_t mepc;
+
+    // MMIO
+    uint8_t led;
+    uint32_t fb_addr;
+
+    int exit_led;               // -1: no sentinel
+    bool stop;                  // set by an instruction to leave the loop
+    sim_iss_stop_t reason;
+};
+
+// Starts at pc with zeroed registers
+void sim_iss_init(sim_iss_t *s, uint16_t *mem, size_t size, sim_uart_t *uart, uint32_t pc, int exit_led);
+
+// Runs until the PC reaches marker, for at most max_cycles cycles (0: no limit)
+sim_iss_stop_t sim_iss_run(sim_iss_t *s, uint32_t marker, uint64_t max_cycles);
+
+// Address of a symbol of an ELF file. Returns false if not found.
+bool sim_iss_find_symbol(const char *elf_path, const char *name, uint32_t *addr);
+
+// To be called before evaluating the first positive edge of clk with the
+// processor out of reset (cpu_reset_o low), in the WAIT_ALU_OR_MEM state
+void sim_iss_handoff(sim_iss_t *s, Vtop *top);
+
+#endif  // SIM_ISS_H
@@ -2,13 +2,16 @@
 // Copyright (c) 2023-2024 Daniel Cliche
 // SPDX-License-Identifier: MIT
 
-#include <SDL.h>
-
 #include <memory>
 #include <chrono>
-#include <deque>
-#include <fstream>
-#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#ifndef HEADLESS
+#include <thread>
+#endif // HEADLESS
 
 #include <verilated.h>
 #include <iostream>
@@ -16,9 +19,62 @@
 // Include model header, generated from Verilating "top.v"
 #include "Vtop.h"
 
+#ifndef HEADLESS
 #include "sdl_ps2.h"
+#include "sim_display.h"
+#else // HEADLESS
+struct sim_display_t;
+#endif // HEADLESS
+
+#include "sim_mem.h"
+#include "sim_uart.h"
+#include "sim_sd.h"
+#include "sim_input.h"
+#include "sim_fb.h"
+#include "sim_video.h"
+#include "sim_backdoor.h"
+#include "sim_iss.h"
+#include "sim_rtl.h"
+
+#ifdef SDRAM_TLM
+#include "sdram_tlm.h"
+#endif // SDRAM_TLM
+
+#ifdef SNAPSHOT
+#include "sim_snapshot.h"
+#endif // SNAPSHOT
+
+#ifdef PERF
+#include "sim_perf.h"
+#endif // PERF
+
+#ifdef PROF
+#include "sim_prof.h"
+#endif // PROF
+
+#ifdef GDB
+#include "sim_gdb.h"
+#endif // GDB
 
-#define SDRAM_MEM_SIZE (32*1024*1024/2)
+#ifdef TRACE
+#include "sim_trace.h"
+#endif // TRACE
+
+#ifdef CACHE_TRACE
+#include "sim_cache_trace.h"
+#endif // CACHE_TRACE
+
+#define SDRAM_MEM_SIZE (32*1024*1024/2)   // 16-bit words
+
+// The wall clock is only sampled once every CLOCK_CHECK_INTERVAL iterations
+// of the simulation loop (one iteration per clk_sdram edge)
+#define CLOCK_CHECK_INTERVAL 4096
+
+// CPU cycles per UART bit (FREQ_HZ / BAUD_RATE + 1 in soc_top)
+#define UART_BIT_CYCLES (CPU_FREQ_HZ / 115200 + 1)
+
+// Minimum CPU cycles between two PS/2 codes
+#define INPUT_GAP_CYCLES 1000
 
 const int screen_width = 1024;
 const int screen_height = 768;
@@ -31,61 +87,400 @@ const int vga_height = 525;
 // const int vga_width = 1088;
 // const int vga_height = 517;
 
+#ifdef SNAPSHOT
+// Harness state saved in snapshots along with the model
+struct sim_state_t {
+    uint64_t time;
+    uint64_t cycles;
+    int clk_counter;
+    bool manual_reset;
+#ifdef SDRAM_TLM
+    sdram_tlm_t sdram_tlm;
+#else // SDRAM_TLM
+    uint32_t sdram_rows[4];
+    uint32_t sdram_col;
+    uint32_t sdram_addr;
+    uint8_t burst_counter;
+    int delay_burst;
+    bool write_sdram;
+    bool read_sdram;
+#endif // SDRAM_TLM
+    sim_uart_state_t uart;
+    sim_sd_state_t sd;
+    sim_input_state_t input;
+    sim_video_t video;
+};
+#endif // SNAPSHOT
+
+// Context of the running model
+static VerilatedContext *sim_contextp = nullptr;
+
+// Simulation time, in units of the model time precision
 double sc_time_stamp()
 {
-    return 0.0;
+    return sim_contextp ? (double)sim_contextp->time() : 0.0;
 }
 
-int main(int argc, char **argv, char **env)
+// The .elf file next to the .hex or .bin image
+static std::string program_elf(const char *program)
 {
-    SDL_Init(SDL_INIT_VIDEO);
+    std::string elf = program;
+    size_t dot = elf.rfind('.');
+    if (dot != std::string::npos && elf.find('/', dot) == std::string::npos)
+        elf.erase(dot);
+    return elf + ".elf";
+}
 
-    SDL_Window *window = SDL_CreateWindow(
-        "XGSoC Simulation",
-        SDL_WINDOWPOS_UNDEFINED_DISPLAY(1),
-        SDL_WINDOWPOS_UNDEFINED,
-        screen_width,
-        screen_height,
-        0);
+static void usage(const char *name)
+{
+    std::cerr << "Usage: " << name << " [options] [+verilator+...]\n"
+              << "  --program <file>    program to load (.elf, .bin, .hex or none, default: program.hex)\n"
+              << "  --headless          run without display (implied by a headless build)\n"
+              << "  --max-cycles <n>    stop after <n> CPU cycles\n"
+              << "  --timeout <s>       stop after <s> seconds of wall-clock time\n"
+              << "  --exit-led <value>  stop when <value> is written to the LED register\n"
+              << "  --uart <mode>       connect the UART to none, stdio or pty (default: none)\n"
+              << "  --uart-bit-cycles <n> CPU cycles per UART bit (default: " << UART_BIT_CYCLES << ")\n"
+              << "  --sd-image <file>   SD card image (default: no card)\n"
+              << "  --sd-latency <n>    SD card access latency in SPI bytes (default: 16)\n"
+              << "  --input <file>      replay the keyboard and mouse events of <file>\n"
+              << "  --input-record <file> record the keyboard and mouse events to <file>\n"
+              << "  --fb-frames <list>  capture the frames of the comma-separated list and stop\n"
+              << "  --fb-prefix <prefix> captured frames: <prefix>_<frame>.ppm|.png (default: frame)\n"
+              << "  --fb-format <fmt>   ppm or png (default: ppm)\n"
+              << "  --fb-golden <prefix> compare the captured frames to <prefix>_<frame>.ppm\n"
+              << "  --fb-tolerance <n>  max. difference per color component (default: 0)\n"
+              << "  --backdoor <socket> serve the memory backdoor on a Unix socket\n"
+              << "  --video <mode>      scan out continuously (on), one frame on demand (demand,\n"
+              << "                      F2 key) or every <n> CPU cycles (default: on)\n"
+              << "  --ff-to <addr>      run the program on the instruction-set model up to <addr>\n"
+              << "                      (or symbol of the program .elf), then on the RTL\n"
+#ifdef SNAPSHOT
+              << "  --save <file>       snapshot file for --save-at and F5/F9 (default: snapshot.xgs)\n"
+              << "  --save-at <n>       save a snapshot after <n> CPU cycles\n"
+              << "  --restore <file>    start from a snapshot instead of loading the program\n"
+#endif // SNAPSHOT
+#ifdef PERF
+              << "  --perf <file>       write the performance counters to <file> (.csv or .json)\n"
+              << "  --perf-interval <n> CPU cycles per performance sample (default: 100000)\n"
+#endif // PERF
+#ifdef PROF
+              << "  --prof <prefix>     write the PC profile to <prefix>.folded/.funcs/.pcs\n"
+              << "  --prof-interval <n> sample the PC every <n> CPU cycles, 0 to count every\n"
+              << "                      executed instruction (default: 100)\n"
+              << "  --prof-elf <file>   symbols of the profiled program (default: program .elf)\n"
+#endif // PROF
+#ifdef TRACE
+              << "  --trace <file>      write an FST trace of the window below to <file>\n"
+              << "  --trace-start <n>   open the window at CPU cycle <n> (default: 0)\n"
+              << "  --trace-stop <n>    close the window at CPU cycle <n>\n"
+              << "  --trace-pc <addr>   open the window once the CPU executes <addr>\n"
+              << "  --trace-mmio <addr> open the window on a CPU store to <addr>\n"
+              << "  --trace-cycles <n>  close the window <n> CPU cycles after it opened\n"
+              << "  --trace-ring <n>    keep (at least) the last <n> cycles before the\n"
+              << "                      PC/store trigger or the end of the run\n"
+#endif // TRACE
+#ifdef GDB
+              << "  --gdb <port>        wait for gdb on TCP port <port>, halted on the first instruction\n"
+#endif // GDB
+#ifdef CACHE_TRACE
+              << "  --cache-trace <file> record the requests served by the cache to <file>\n"
+#endif // CACHE_TRACE
+              ;
+}
 
-    SDL_Renderer *renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+// Runs the simulation, presented on display (nullptr if headless)
+static int simulate(int argc, char **argv, sim_display_t *display)
+{
+    uint64_t max_cycles = 0;    // 0: no limit
+    double timeout = 0.0;       // 0: no limit
+    int exit_led = -1;          // -1: no sentinel
+    const char *program = "program.hex";
+    sim_uart_mode_t uart_mode = SIM_UART_NONE;
+    int uart_bit_cycles = UART_BIT_CYCLES;
+    const char *sd_image = nullptr;
+    int sd_latency = 16;
+    const char *input_path = nullptr;
+    const char *input_record_path = nullptr;
+    const char *fb_frames = nullptr;
+    const char *fb_prefix = "frame";
+    const char *fb_format = "ppm";
+    const char *fb_golden = nullptr;
+    int fb_tolerance = 0;
+    const char *backdoor_path = nullptr;
+    bool video_throttled = false;
+    uint64_t video_period = 0;
+    const char *ff_to = nullptr;
+#ifdef SNAPSHOT
+    const char *snapshot_path = "snapshot.xgs";
+    const char *restore_path = nullptr;
+    uint64_t save_at = 0;       // 0: no automatic snapshot
+#endif // SNAPSHOT
+#ifdef PERF
+    const char *perf_path = nullptr;
+    uint64_t perf_interval = 100000;
+#endif // PERF
+#ifdef PROF
+    const char *prof_prefix = nullptr;
+    uint64_t prof_interval = 100;
+    std::string prof_elf;
+#endif // PROF
+#ifdef GDB
+    int gdb_port = 0;           // 0: no stub
+#endif // GDB
+#ifdef TRACE
+    const char *trace_path = nullptr;
+    uint64_t trace_start = 0;
+    uint64_t trace_stop = 0;    // 0: no limit
+    uint64_t trace_cycles = 0;  // 0: no limit
+    uint64_t trace_ring = 0;    // 0: no ring
+    int64_t trace_pc = -1;      // -1: no trigger
+    int64_t trace_mmio = -1;    // -1: no trigger
+#endif // TRACE
+#ifdef CACHE_TRACE
+    const char *cache_trace_path = nullptr;
+#endif // CACHE_TRACE
+
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i][0] == '+') {
+            // Verilator plusargs, handled by the context
+            continue;
+        } else if (!strcmp(argv[i], "--program") && i + 1 < argc) {
+            // "none": the firmware boots as on the board (e.g. from the SD card)
+            ++i;
+            program = strcmp(argv[i], "none") ? argv[i] : nullptr;
+        } else if (!strcmp(argv[i], "--headless")) {
+            // see main()
+        } else if (!strcmp(argv[i], "--max-cycles") && i + 1 < argc) {
+            max_cycles = strtoull(argv[++i], nullptr, 0);
+        } else if (!strcmp(argv[i], "--timeout") && i + 1 < argc) {
+            timeout = strtod(argv[++i], nullptr);
+        } else if (!strcmp(argv[i], "--exit-led") && i + 1 < argc) {
+            exit_led = (int)strtol(argv[++i], nullptr, 0);
+            if (exit_led > 0xFF)
+                exit_led &= 0xFF;
+        } else if (!strcmp(argv[i], "--uart") && i + 1 < argc) {
+            ++i;
+            if (!strcmp(argv[i], "none")) {
+                uart_mode = SIM_UART_NONE;
+            } else if (!strcmp(argv[i], "stdio")) {
+                uart_mode = SIM_UART_STDIO;
+            } else if (!strcmp(argv[i], "pty")) {
+                uart_mode = SIM_UART_PTY;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "--uart-bit-cycles") && i + 1 < argc) {
+            uart_bit_cycles = (int)strtol(argv[++i], nullptr, 0);
+        } else if (!strcmp(argv[i], "--sd-image") && i + 1 < argc) {
+            sd_image = argv[++i];
+        } else if (!strcmp(argv[i], "--sd-latency") && i + 1 < argc) {
+            sd_latency = (int)strtol(argv[++i], nullptr, 0);
+        } else if (!strcmp(argv[i], "--input") && i + 1 < argc) {
+            input_path = argv[++i];
+        } else if (!strcmp(argv[i], "--input-record") && i + 1 < argc) {
+            input_record_path = argv[++i];
+        } else if (!strcmp(argv[i], "--fb-frames") && i + 1 < argc) {
+            fb_frames = argv[++i];
+        } else if (!strcmp(argv[i], "--fb-prefix") && i + 1 < argc) {
+            fb_prefix = argv[++i];
+        } else if (!strcmp(argv[i], "--fb-format") && i + 1 < argc) {
+            fb_format = argv[++i];
+        } else if (!strcmp(argv[i], "--fb-golden") && i + 1 < argc) {
+            fb_golden = argv[++i];
+        } else if (!strcmp(argv[i], "--fb-tolerance") && i + 1 < argc) {
+            fb_tolerance = (int)strtol(argv[++i], nullptr, 0);
+        } else if (!strcmp(argv[i], "--backdoor") && i + 1 < argc) {
+            backdoor_path = argv[++i];
+        } else if (!strcmp(argv[i], "--video") && i + 1 < argc) {
+            ++i;
+            if (!strcmp(argv[i], "on")) {
+                video_throttled = false;
+            } else if (!strcmp(argv[i], "demand")) {
+                video_throttled = true;
+                video_period = 0;
+            } else {
+                char *end;
+                video_throttled = true;
+                video_period = strtoull(argv[i], &end, 0);
+                if (*end || !video_period) {
+                    usage(argv[0]);
+                    return 1;
+                }
+            }
+        } else if (!strcmp(argv[i], "--ff-to") && i + 1 < argc) {
+            ff_to = argv[++i];
+#ifdef SNAPSHOT
+        } else if (!strcmp(argv[i], "--save") && i + 1 < argc) {
+            snapshot_path = argv[++i];
+        } else if (!strcmp(argv[i], "--save-at") && i + 1 < argc) {
+            save_at = strtoull(argv[++i], nullptr, 0);
+        } else if (!strcmp(argv[i], "--restore") && i + 1 < argc) {
+            restore_path = argv[++i];
+#endif // SNAPSHOT
+#ifdef PERF
+        } else if (!strcmp(argv[i], "--perf") && i + 1 < argc) {
+            perf_path = argv[++i];
+        } else if (!strcmp(argv[i], "--perf-interval") && i + 1 < argc) {
+            perf_interval = strtoull(argv[++i], nullptr, 0);
+#endif // PERF
+#ifdef PROF
+        } else if (!strcmp(argv[i], "--prof") && i + 1 < argc) {
+            prof_prefix = argv[++i];
+        } else if (!strcmp(argv[i], "--prof-interval") && i + 1 < argc) {
+            prof_interval = strtoull(argv[++i], nullptr, 0);
+        } else if (!strcmp(argv[i], "--prof-elf") && i + 1 < argc) {
+            prof_elf = argv[++i];
+#endif // PROF
+#ifdef TRACE
+        } else if (!strcmp(argv[i], "--trace") && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (!strcmp(argv[i], "--trace-start") && i + 1 < argc) {
+            trace_start = strtoull(argv[++i], nullptr, 0);
+        } else if (!strcmp(argv[i], "--trace-stop") && i + 1 < argc) {
+            trace_stop = strtoull(argv[++i], nullptr, 0);
+        } else if (!strcmp(argv[i], "--trace-pc") && i + 1 < argc) {
+            trace_pc = strtoll(argv[++i], nullptr, 0);
+        } else if (!strcmp(argv[i], "--trace-mmio") && i + 1 < argc) {
+            trace_mmio = strtoll(argv[++i], nullptr, 0);
+        } else if (!strcmp(argv[i], "--trace-cycles") && i + 1 < argc) {
+            trace_cycles = strtoull(argv[++i], nullptr, 0);
+        } else if (!strcmp(argv[i], "--trace-ring") && i + 1 < argc) {
+            trace_ring = strtoull(argv[++i], nullptr, 0);
+#endif // TRACE
+#ifdef GDB
+        } else if (!strcmp(argv[i], "--gdb") && i + 1 < argc) {
+            gdb_port = (int)strtol(argv[++i], nullptr, 0);
+#endif // GDB
+#ifdef CACHE_TRACE
+        } else if (!strcmp(argv[i], "--cache-trace") && i + 1 < argc) {
+            cache_trace_path = argv[++i];
+#endif // CACHE_TRACE
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+#ifdef PROF
+    if (prof_elf.empty() && program)
+        prof_elf = program_elf(program);
+#endif // PROF
+
+    // Fast-forward marker: an address or a symbol of the program
+    uint32_t ff_marker = 0;
+    if (ff_to) {
+        char *end;
+        ff_marker = (uint32_t)strtoul(ff_to, &end, 0);
+        if (!program) {
+            std::cerr << "--ff-to requires a program\n";
+            return 1;
+        }
+        if (*end && !sim_iss_find_symbol(program_elf(program).c_str(), ff_to, &ff_marker)) {
+            std::cerr << ff_to << ": symbol not found in " << program_elf(program) << "\n";
+            return 1;
+        }
+    }
 
     // Create logs/ directory in case we have traces to put under it
     Verilated::mkdir("logs");
 
-
-    const size_t pixels_size = vga_width * vga_height * 4;
-    unsigned char *pixels = new unsigned char[pixels_size];
-
-    SDL_Texture *texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, vga_width, vga_height);
-
-    uint16_t *sdram_mem = new uint16_t[SDRAM_MEM_SIZE];
+    uint16_t *sdram_mem = sim_mem_alloc(SDRAM_MEM_SIZE * sizeof(uint16_t));
+    assert(sdram_mem);
+#ifdef SDRAM_TLM
+    sdram_tlm_t sdram_tlm;
+#else // SDRAM_TLM
     uint32_t sdram_rows[4] = {0, 0, 0, 0};  // 2^13 = 8192 rows per bank
     uint32_t sdram_col = 0; // 2^9 = 512 columns
     uint32_t sdram_addr = 0;
     uint8_t burst_counter = 0;
-
+#endif // SDRAM_TLM
+
+    sim_uart_t uart;
+    sim_sd_t sd;
+    sim_input_t input;
+    sim_backdoor_t backdoor;
+#ifdef GDB
+    sim_gdb_t gdb;
+#endif // GDB
+    sim_fb_t fb;
     bool restart_model;
+    int exit_code = 1;
+
+    // A module whose open fails is left closable: the cleanup at the end
+    // starts with it
+    if (!sim_uart_open(&uart, uart_mode, uart_bit_cycles))
+        goto free_mem;
+    if (!sim_sd_open(&sd, sd_image, sd_latency))
+        goto close_sd;
+    if (!sim_input_open(&input, input_path, input_record_path, INPUT_GAP_CYCLES))
+        goto close_input;
+    if (!sim_backdoor_open(&backdoor, backdoor_path, sdram_mem, SDRAM_MEM_SIZE * sizeof(uint16_t)))
+        goto close_backdoor;
+#ifdef GDB
+    if (!sim_gdb_open(&gdb, gdb_port, sdram_mem, SDRAM_MEM_SIZE * sizeof(uint16_t)))
+        goto cleanup;
+#endif // GDB
+    if (fb_frames && !sim_fb_open(&fb, fb_frames, fb_prefix, fb_format, fb_golden, fb_tolerance))
+        goto cleanup;
+
+    exit_code = 0;
+
     do {
+        sim_iss_t iss;
+        bool ff_pending = false;
+        uint64_t ff_cycles = 0;     // run on the instruction-set model
+
+#ifdef SNAPSHOT
+        // The memory is restored from the snapshot
+        if (!restore_path) {
+#endif // SNAPSHOT
+        auto tp_load = std::chrono::high_resolution_clock::now();
+
+        sim_mem_clear(sdram_mem, SDRAM_MEM_SIZE * sizeof(uint16_t));
+        if (program) {
+            long program_size = sim_mem_load_program(sdram_mem, SDRAM_MEM_SIZE * sizeof(uint16_t), program);
+            if (program_size < 0) {
+                exit_code = 1;
+                break;
+            }
 
-        for (size_t i = 0; i < SDRAM_MEM_SIZE; ++i)
-            sdram_mem[i] = 0x0000;
+            std::chrono::duration<double> duration_load = std::chrono::high_resolution_clock::now() - tp_load;
+            std::cout << "Loaded " << program << " (" << program_size << " bytes) in "
+                      << duration_load.count() * 1000.0 << " ms\n";
+        }
 
-        std::ifstream file("program.hex", std::ifstream::in);
-        size_t addr = 0;
-        std::string str;
-        while (std::getline(file, str))
-        {
-            uint32_t v;
-            std::stringstream ss;
-            ss << std::hex << str;
-            ss >> v;
-            //sdram_mem[addr] = v >> 16;
-            //sdram_mem[addr + 1] = v & 0xFFFF;
-            sdram_mem[addr + 1] = v >> 16;
-            sdram_mem[addr] = v & 0xFFFF;
-            addr += 2;
+        // Up to the marker on the instruction-set model, whose state is then
+        // handed to the RTL once out of reset
+        if (ff_to) {
+            auto tp_ff = std::chrono::high_resolution_clock::now();
+            sim_iss_init(&iss, sdram_mem, SDRAM_MEM_SIZE * sizeof(uint16_t), &uart, 0, exit_led);
+            sim_iss_stop_t reason = sim_iss_run(&iss, ff_marker, max_cycles);
+
+            std::chrono::duration<double> duration_ff = std::chrono::high_resolution_clock::now() - tp_ff;
+            std::cout << "Fast-forwarded " << iss.cycles << " instructions in "
+                      << duration_ff.count() * 1000.0 << " ms ("
+                      << iss.cycles / duration_ff.count() / 1e6 << " MIPS)\n";
+
+            if (reason == SIM_ISS_EXIT_LED) {
+                std::cout << "Sentinel written to LED register\n";
+                break;
+            } else if (reason == SIM_ISS_BUDGET) {
+                std::cout << "Cycle budget reached\n";
+                if (exit_led >= 0)
+                    exit_code = 1;
+                break;
+            } else if (reason == SIM_ISS_ERROR) {
+                exit_code = 1;
+                break;
+            }
+            ff_pending = true;
+            ff_cycles = iss.cycles;
+        }
+#ifdef SNAPSHOT
         }
+#endif // SNAPSHOT
 
         // Construct a VerilatedContext to hold simulation time, etc.
         // Multiple modules (made later below with Vtop) may share the same
@@ -107,6 +502,12 @@ int main(int argc, char **argv, char **env)
         // Verilator must compute traced signals
         contextp->traceEverOn(true);
 
+#ifdef TRACE
+        // A failed assertion ends the run normally, to keep the trace
+        if (trace_path)
+            contextp->fatalOnError(false);
+#endif // TRACE
+
         // Pass arguments so Verilated code can see them, e.g. $value$plusargs
         // This needs to be called before you create any model
         contextp->commandArgs(argc, argv);
@@ -117,36 +518,177 @@ int main(int argc, char **argv, char **env)
         // Using unique_ptr is similar to "Vtop* top = new Vtop" then deleting at end.
         // "TOP" will be the hierarchical name of the module.
         const std::unique_ptr<Vtop> top{new Vtop{contextp.get(), "TOP"}};
+        sim_contextp = contextp.get();
+
+        // Simulation time per iteration (clk_sdram edge, twice the CPU clock:
+        // a quarter of a CPU cycle), in units of the model time precision
+        // (1 ps unless set by a `timescale), so that $time and the traces
+        // show the time of the board
+        const uint64_t time_step = std::max<uint64_t>(1,
+            std::llround(std::pow(10.0, -contextp->timeprecision()) / (4.0 * CPU_FREQ_HZ)));
 
         // Set Vtop's input signals
         top->reset_i = 1;
         top->clk = 0;
+        top->clk_pixel = 0;
+        top->rx_i = 1;
+        top->sd_do_i = 1;
 
-        SDL_Event e;
         bool quit = false;
 
-        auto tp_frame = std::chrono::high_resolution_clock::now();
-        auto tp_clk = std::chrono::high_resolution_clock::now();
-        auto tp_now = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> duration_clk;
+        auto tp_start = std::chrono::high_resolution_clock::now();
+        auto tp_now = tp_start;
 
-        unsigned int frame_counter = 0;
-        bool was_vsync = false;
+        uint64_t cycles = 0;
+        uint64_t start_cycles = 0;
+        uint8_t last_led = 0;
 
-        size_t pixel_index = 0;
+#ifndef HEADLESS
+        auto tp_clk = tp_start;
+        uint64_t cycles_clk = 0;
 
-        std::deque<uint8_t> ps2_keys;
+        const size_t pixels_size = vga_width * vga_height * 4;
+        bool was_vsync = false;
+        size_t pixel_index = 0;
+#endif // HEADLESS
 
         top->clk = 0;
         top->clk_sdram = 0;
 
         int clk_counter = 0;
+#ifdef SDRAM_TLM
+        sdram_tlm_reset(&sdram_tlm);
+#else // SDRAM_TLM
         int delay_burst = 0;
         bool write_sdram = false;
         bool read_sdram = false;
+#endif // SDRAM_TLM
 
         bool manual_reset = false;
 
+#ifdef PERF
+        sim_perf_t perf;
+        if (!sim_perf_open(&perf, perf_path, perf_interval)) {
+            exit_code = 1;
+            quit = true;
+        }
+#endif // PERF
+
+        sim_video_t video;
+        sim_video_open(&video, video_throttled, video_period);
+
+#ifdef PROF
+        sim_prof_t prof;
+        if (prof_prefix)
+            sim_prof_open(&prof, prof_prefix, prof_elf.c_str(), prof_interval);
+#endif // PROF
+
+#ifdef TRACE
+        sim_trace_t trace;
+        sim_trace_open(&trace, trace_path, trace_start, trace_stop, trace_cycles, trace_ring,
+                       trace_pc, trace_mmio);
+#endif // TRACE
+
+#ifdef CACHE_TRACE
+        sim_cache_trace_t cache_trace;
+        if (!sim_cache_trace_open(&cache_trace, cache_trace_path)) {
+            exit_code = 1;
+            quit = true;
+        }
+#endif // CACHE_TRACE
+
+#ifdef SNAPSHOT
+        sim_state_t state;
+
+        auto save_snapshot = [&](const char *path) {
+            memset(&state, 0, sizeof(state));
+            state.time = contextp->time();
+            state.cycles = cycles;
+            state.clk_counter = clk_counter;
+            state.manual_reset = manual_reset;
+            state.video = video;
+#ifdef SDRAM_TLM
+            state.sdram_tlm = sdram_tlm;
+#else // SDRAM_TLM
+            memcpy(state.sdram_rows, sdram_rows, sizeof(sdram_rows));
+            state.sdram_col = sdram_col;
+            state.sdram_addr = sdram_addr;
+            state.burst_counter = burst_counter;
+            state.delay_burst = delay_burst;
+            state.write_sdram = write_sdram;
+            state.read_sdram = read_sdram;
+#endif // SDRAM_TLM
+            // The pending UART and SD card bytes and the input queues follow
+            // the fixed state
+            std::vector<uint8_t> queues;
+            sim_uart_save(&uart, &state.uart, &queues);
+            sim_sd_save(&sd, &state.sd, &queues);
+            sim_input_save(&input, &state.input, &queues);
+            std::vector<uint8_t> data((const uint8_t *)&state, (const uint8_t *)&state + sizeof(state));
+            data.insert(data.end(), queues.begin(), queues.end());
+
+            auto tp = std::chrono::high_resolution_clock::now();
+            if (sim_snapshot_save(path, top.get(), data.data(), data.size(), sdram_mem, SDRAM_MEM_SIZE * sizeof(uint16_t))) {
+                std::chrono::duration<double> d = std::chrono::high_resolution_clock::now() - tp;
+                std::cout << "Saved " << path << " at cycle " << cycles << " in " << d.count() * 1000.0 << " ms\n";
+            }
+        };
+
+        auto restore_snapshot = [&](const char *path) {
+            auto tp = std::chrono::high_resolution_clock::now();
+            std::vector<uint8_t> data;
+            if (!sim_snapshot_restore(path, top.get(), &data, sizeof(state), sdram_mem, SDRAM_MEM_SIZE * sizeof(uint16_t)))
+                return false;
+            memcpy(&state, data.data(), sizeof(state));
+            const uint8_t *queues = data.data() + sizeof(state);
+            size_t queues_size = data.size() - sizeof(state);
+            size_t sd_offset = state.uart.rx_len;
+            size_t input_offset = sd_offset + state.sd.out_len;
+            if (queues_size < input_offset ||
+                !sim_uart_restore(&uart, &state.uart, queues, state.uart.rx_len) ||
+                !sim_input_restore(&input, &state.input, queues + input_offset, queues_size - input_offset, state.cycles)) {
+                std::cerr << path << ": corrupted UART, SD card or input queues\n";
+                return false;
+            }
+            if (!sim_sd_restore(&sd, &state.sd, queues + sd_offset, state.sd.out_len)) {
+                std::cerr << path << ": SD card image size differs from the saved one\n";
+                return false;
+            }
+            contextp->time(state.time);
+            cycles = state.cycles;
+            clk_counter = state.clk_counter;
+            manual_reset = state.manual_reset;
+            video = state.video;
+#ifdef SDRAM_TLM
+            sdram_tlm = state.sdram_tlm;
+#else // SDRAM_TLM
+            memcpy(sdram_rows, state.sdram_rows, sizeof(sdram_rows));
+            sdram_col = state.sdram_col;
+            sdram_addr = state.sdram_addr;
+            burst_counter = state.burst_counter;
+            delay_burst = state.delay_burst;
+            write_sdram = state.write_sdram;
+            read_sdram = state.read_sdram;
+#endif // SDRAM_TLM
+            last_led = top->display_o;
+            start_cycles = cycles;
+#ifndef HEADLESS
+            cycles_clk = cycles;
+#endif // HEADLESS
+            std::chrono::duration<double> d = std::chrono::high_resolution_clock::now() - tp;
+            std::cout << "Restored " << path << " at cycle " << cycles << " in " << d.count() * 1000.0 << " ms\n";
+            return true;
+        };
+
+        if (restore_path && !restore_snapshot(restore_path)) {
+            exit_code = 1;
+            quit = true;
+        }
+
+        bool save_request = false;
+        bool restore_request = false;
+#endif // SNAPSHOT
+
         while (!contextp->gotFinish() && !quit)
         {
             bool toggle_clk = !(clk_counter & 0x1);
@@ -160,12 +702,16 @@ int main(int argc, char **argv, char **env)
             if (toggle_clk_sdram)
                 top->clk_sdram = !top->clk_sdram;
 
-            if (toggle_clk)
+            if (toggle_clk) {
                 top->clk = !top->clk;
+                top->clk_pixel = video.on && top->clk;
+            }
 
             // if negedge clk sdram
             if (!top->clk_sdram) {
-
+#ifdef SDRAM_TLM
+                sdram_tlm_negedge(&sdram_tlm, sdram_mem, top.get());
+#else // SDRAM_TLM
                 if (!top->sdram_cs_n_o) {
                     // activate
                     uint32_t sdram_bank = top->sdram_ba_o;
@@ -234,180 +780,334 @@ int main(int argc, char **argv, char **env)
                         delay_burst--;
                     }
                 }
+#endif // SDRAM_TLM
+            }
+            else {
+#ifdef PERF
+                sim_perf_sdram_posedge(&perf, top.get());
+#endif // PERF
+                sim_video_sdram_posedge(&video, top.get());
             }
 
             // if posedge clk
             if (toggle_clk && top->clk) {
-                
-                if (top->ps2_kbd_strobe_i) {
-                    top->ps2_kbd_strobe_i = 0;
 
-                } else {
-                    if (ps2_keys.size() > 0) {
-                        top->ps2_kbd_code_i = ps2_keys.back();
-                        top->ps2_kbd_strobe_i = 1;
-                        ps2_keys.pop_back();
+                cycles++;
+
+                // The RTL takes over from the instruction-set model
+                if (ff_pending && !top->cpu_reset_o && (top->cpu_state_o & CPU_STATE_WAIT_ALU_OR_MEM)) {
+                    sim_iss_handoff(&iss, top.get());
+                    ff_pending = false;
+                }
+
+#ifdef PERF
+                sim_perf_cpu_posedge(&perf, top.get());
+#endif // PERF
+#ifdef PROF
+                if (prof_prefix)
+                    sim_prof_posedge(&prof, top.get());
+#endif // PROF
+#ifdef TRACE
+                sim_trace_posedge(&trace, cycles, top.get());
+#endif // TRACE
+#ifdef CACHE_TRACE
+                sim_cache_trace_posedge(&cache_trace, top.get());
+#endif // CACHE_TRACE
+
+                sim_uart_posedge(&uart, top.get());
+                sim_sd_posedge(&sd, top.get());
+                sim_input_posedge(&input, cycles, top.get());
+                sim_video_posedge(&video, cycles, top.get());
+                sim_backdoor_posedge(&backdoor, cycles, top.get());
+
+#ifdef GDB
+                // Halted before the instruction is decoded, until resumed by gdb
+                sim_gdb_posedge(&gdb, top.get());
+                while (gdb.halted)
+                    sim_gdb_poll(&gdb, top.get(), 100);
+                if (gdb.killed)
+                    quit = true;
+#endif // GDB
+
+                if (fb_frames && top->clk_pixel) {
+                    sim_fb_posedge(&fb, cycles, top.get());
+                    if (sim_fb_done(&fb)) {
+                        std::cout << "Last frame captured\n";
+                        quit = true;
+                    }
+                }
+
+#ifdef SNAPSHOT
+                if (save_at && cycles == save_at)
+                    save_request = true;
+#endif // SNAPSHOT
+
+                if (max_cycles && cycles >= max_cycles) {
+                    std::cout << "Cycle budget reached\n";
+                    // Running out of cycles while waiting for a sentinel is a failure
+                    if (exit_led >= 0)
+                        exit_code = 1;
+                    quit = true;
+                }
+
+                if (top->display_o != last_led) {
+                    last_led = top->display_o;
+                    if ((int)last_led == exit_led) {
+                        std::cout << "Sentinel written to LED register\n";
+                        quit = true;
                     }
                 }
 
                 if (manual_reset) {
                     top->reset_i = 1;
                 } else {
-                    if (contextp->time() > 1 && contextp->time() < 10) {
+                    if (contextp->time() > 1 * time_step && contextp->time() < 10 * time_step) {
                         top->reset_i = 1; // Assert reset
                     } else {
                         top->reset_i = 0; // Deassert reset
                     }
                 }
 
+#ifndef HEADLESS
                 // Update video display
-                if (was_vsync && top->vga_vsync)
-                {
-                    pixel_index = 0;
-                    was_vsync = false;
-                }
+                if (display && top->clk_pixel) {
+                    if (was_vsync && top->vga_vsync)
+                    {
+                        pixel_index = 0;
+                        was_vsync = false;
+                    }
 
-                pixels[pixel_index] = top->vga_r;
-                pixels[pixel_index + 1] = top->vga_g;
-                pixels[pixel_index + 2] = top->vga_b;
-                pixels[pixel_index + 3] = 255;
-                pixel_index = (pixel_index + 4) % (pixels_size);
+                    uint8_t *pixels = sim_display_back(display);
+                    pixels[pixel_index] = top->vga_r;
+                    pixels[pixel_index + 1] = top->vga_g;
+                    pixels[pixel_index + 2] = top->vga_b;
+                    pixels[pixel_index + 3] = 255;
+                    pixel_index = (pixel_index + 4) % (pixels_size);
 
-                if (!top->vga_vsync && !was_vsync)
-                {
-                    was_vsync = true;
-                    void *p;
-                    int pitch;
-                    SDL_LockTexture(texture, NULL, &p, &pitch);
-                    assert(pitch == vga_width * 4);
-                    memcpy(p, pixels, vga_width * vga_height * 4);
-                    SDL_UnlockTexture(texture);
+                    // Complete frame, handed to the main thread
+                    if (!top->vga_vsync && !was_vsync)
+                    {
+                        was_vsync = true;
+                        sim_display_publish(display);
+                    }
                 }
+#endif // HEADLESS
             }
 
+            contextp->timeInc(time_step);
+            top->eval();
+#ifdef TRACE
+            sim_trace_dump(&trace, contextp->time());
+#endif // TRACE
+
+#ifdef SNAPSHOT
+            // Snapshots are taken between two iterations, once the model has settled
+            if (save_request) {
+                save_request = false;
+                save_snapshot(snapshot_path);
+            }
+            if (restore_request) {
+                restore_request = false;
+                restore_snapshot(snapshot_path);
+            }
+#endif // SNAPSHOT
+
+            // Stopped on a watched store, until resumed by the backdoor client
+            while (backdoor.paused)
+                sim_backdoor_poll(&backdoor, cycles, 100);
+
+            if (clk_counter % CLOCK_CHECK_INTERVAL != 0)
+                continue;
+
+            sim_uart_poll(&uart);
+            sim_backdoor_poll(&backdoor, cycles, 0);
+#ifdef GDB
+            sim_gdb_poll(&gdb, top.get(), 0);
+            if (gdb.killed)
+                quit = true;
+#endif // GDB
+
             tp_now = std::chrono::high_resolution_clock::now();
-            std::chrono::duration<double> duration_frame = tp_now - tp_frame;
 
-            if (contextp->time() % 2000000 == 0)
+            if (timeout > 0.0 && std::chrono::duration<double>(tp_now - tp_start).count() >= timeout) {
+                std::cout << "Timeout\n";
+                exit_code = 1;
+                quit = true;
+            }
+
+#ifndef HEADLESS
+            std::chrono::duration<double> duration_since_clk = tp_now - tp_clk;
+            if (display && duration_since_clk.count() >= 2.0)
             {
-                duration_clk = tp_now - tp_clk;
+                std::cout << "Clk speed: " << (cycles - cycles_clk) / duration_since_clk.count() / 1e6 << " MHz\n";
                 tp_clk = tp_now;
+                cycles_clk = cycles;
             }
 
-            if (duration_frame.count() >= 1.0 / 60.0)
+            // Events forwarded by the main thread
+            sim_display_event_t e;
+            while (display && sim_display_poll(display, &e))
             {
-                while (SDL_PollEvent(&e))
+                if (e.type == SIM_DISPLAY_QUIT)
                 {
-                    if (e.type == SDL_QUIT)
+                    quit = true;
+                }
+                else if (e.type == SIM_DISPLAY_KEY_UP)
+                {
+                    switch (e.sym)
                     {
+                    case SDLK_F1:
+                        std::cout << "Reset released\n";
+                        manual_reset = false;
+                        break;
+                    case SDLK_F12:
                         quit = true;
-                    }
-                    else if (e.type == SDL_KEYUP)
-                    {
-                        switch (e.key.keysym.sym)
+                        restart_model = true;
+                        break;
+                    case SDLK_F2:
+                        sim_video_request(&video);
+                        break;
+#ifdef SNAPSHOT
+                    case SDLK_F5:
+                        save_request = true;
+                        break;
+                    case SDLK_F9:
+                        restore_request = true;
+                        break;
+#endif // SNAPSHOT
+                    default:
                         {
-                        case SDLK_F1:
-                            std::cout << "Reset released\n";
-                            manual_reset = false;
-                            break;
-                        case SDLK_F12:
-                            quit = true;
-                            restart_model = true;
+                            uint8_t out[MAX_PS2_CODE_LEN];
+                            int n = ps2_encode(e.scancode, false, out);
+                            sim_input_kbd(&input, out, n);
                             break;
-                        default:
-                            {
-                                uint8_t out[MAX_PS2_CODE_LEN];
-                                int n = ps2_encode(e.key.keysym.scancode, false, out);
-                                for (int i = 0; i < n; ++i)
-                                    ps2_keys.emplace_front(out[i]);
-                                break;
-                            }
                         }
                     }
-                    else if (e.type == SDL_KEYDOWN)
+                }
+                else if (e.type == SIM_DISPLAY_KEY_DOWN)
+                {
+                    switch (e.sym)
                     {
-                        if (e.key.repeat == 0)
+                    case SDLK_F1:
+                        std::cout << "Reset pressed\n";
+                        manual_reset = true;
+                        break;
+                    case SDLK_F12:
+                        std::cout << "Reset context\n";
+                        break;
+                    case SDLK_F2:
+                        break;
+#ifdef SNAPSHOT
+                    case SDLK_F5:
+                    case SDLK_F9:
+                        break;
+#endif // SNAPSHOT
+                    default:
                         {
-                            switch (e.key.keysym.sym)
-                            {
-                            case SDLK_F1:
-                                std::cout << "Reset pressed\n";
-                                manual_reset = true;
-                                break;                                
-                            case SDLK_F12:
-                                std::cout << "Reset context\n";
-                                break;
-                            default:
-                                {
-                                    uint8_t out[MAX_PS2_CODE_LEN];
-                                    int n = ps2_encode(e.key.keysym.scancode, true, out);
-                                    for (int i = 0; i < n; ++i)
-                                        ps2_keys.emplace_front(out[i]);
-                                    break;
-                                }
-                            }
+                            uint8_t out[MAX_PS2_CODE_LEN];
+                            int n = ps2_encode(e.scancode, true, out);
+                            sim_input_kbd(&input, out, n);
+                            break;
                         }
                     }
                 }
-
-                int draw_w, draw_h;
-                SDL_GL_GetDrawableSize(window, &draw_w, &draw_h);
-
-                int scale_x, scale_y;
-                scale_x = draw_w / screen_width;
-                scale_y = draw_h / screen_height;
-
-                SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
-                SDL_RenderClear(renderer);
-
-                if (frame_counter % 100 == 0)
+                else if (e.type == SIM_DISPLAY_MOUSE)
                 {
-                    std::cout << "Clk speed: " << 1.0 / (duration_clk.count()) << " MHz\n";
+                    sim_input_mouse(&input, e.btn, e.dx, e.dy, e.dz);
                 }
-
-                tp_frame = tp_now;
-                frame_counter++;
-
-                // Read outputs
-                //VL_PRINTF("[%" VL_PRI64 "d] clk=%x rstl=%x led=%02x\n",
-                //          contextp->time(), top->clk, top->reset_l, top->led);
-
-                SDL_Rect vga_r = {0, scale_x * (screen_height - vga_height - 1), scale_x * vga_width, scale_y * vga_height};
-                SDL_RenderCopy(renderer, texture, NULL, &vga_r);
-
-                int x = 0;
-                int y = 0;
-                for (int i = 7; i >= 0; --i)
-                {
-                    SDL_Rect r{scale_x * x, scale_y * y, scale_x * 50, scale_y * 50};
-                    SDL_SetRenderDrawColor(renderer, 30, (top->display_o >> i) & 1 ? 255 : 30, 30, 255);
-                    SDL_RenderFillRect(renderer, &r);
-                    x += 60;
-                }
-
-                SDL_RenderPresent(renderer);
             }
 
-            contextp->timeInc(1);
-            top->eval();
-
-            //if (contextp->time() > 20000)
-            //    quit = true;            
-
+            if (display)
+                sim_display_led(display, top->display_o);
+#endif // HEADLESS
         }
 
+        // The simulated time is the one of the board, as counted by the
+        // TIMER register: the benchmark timings are those of the hardware
+        std::chrono::duration<double> duration_run = std::chrono::high_resolution_clock::now() - tp_start;
+        double clk_speed = (cycles - start_cycles) / duration_run.count();
+        std::cout << "LED: 0x" << std::hex << (int)top->display_o << std::dec
+                  << ", cycles: " << cycles
+                  << ", simulated time: " << (ff_cycles + cycles) * 1000.0 / CPU_FREQ_HZ << " ms"
+                  << ", time: " << duration_run.count() << " s"
+                  << ", clk speed: " << clk_speed / 1e6 << " MHz (1/" << CPU_FREQ_HZ / clk_speed
+                  << " of real time)\n";
+
+        sim_video_close(&video);
+
+        // Missing or mismatching frames
+        if (fb_frames && (fb.failures || !sim_fb_done(&fb)))
+            exit_code = 1;
+
+#ifdef PERF
+        sim_perf_close(&perf);
+#endif // PERF
+#ifdef PROF
+        if (prof_prefix)
+            sim_prof_close(&prof);
+#endif // PROF
+#ifdef TRACE
+        sim_trace_close(&trace, cycles);
+        if (contextp->gotError())
+            exit_code = 1;
+#endif // TRACE
+#ifdef CACHE_TRACE
+        sim_cache_trace_close(&cache_trace);
+#endif // CACHE_TRACE
+
         // Final model cleanup
         top->final();
-    } while (restart_model);
+        sim_contextp = nullptr;
 
-    delete[] sdram_mem;
-
-    SDL_DestroyTexture(texture);
-
-    delete[] pixels;
+        if (restart_model)
+            sim_input_reset(&input);
+    } while (restart_model);
 
-    SDL_DestroyWindow(window);
-    SDL_Quit();
+cleanup:
+#ifdef GDB
+    sim_gdb_close(&gdb);
+#endif // GDB
+close_backdoor:
+    sim_backdoor_close(&backdoor);
+close_input:
+    sim_input_close(&input);
+close_sd:
+    sim_sd_close(&sd);
+    sim_uart_close(&uart);
+free_mem:
+    sim_mem_free(sdram_mem, SDRAM_MEM_SIZE * sizeof(uint16_t));
+
+    return exit_code;
+}
 
-    return 0;
+int main(int argc, char **argv, char **env)
+{
+#ifndef HEADLESS
+    bool headless = false;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--headless"))
+            headless = true;
+    }
+
+    if (!headless) {
+        // SDL stays on the main thread (a requirement on macOS), the model is
+        // evaluated on its own thread
+        sim_display_t display;
+        if (!sim_display_open(&display, screen_width, screen_height, vga_width, vga_height))
+            return 1;
+
+        int exit_code = 0;
+        std::thread sim_thread([&] {
+            exit_code = simulate(argc, argv, &display);
+            sim_display_stop(&display);
+        });
+        sim_display_run(&display);
+        sim_thread.join();
+
+        sim_display_close(&display);
+        return exit_code;
+    }
+#endif // HEADLESS
+
+    return simulate(argc, argv, nullptr);
 }
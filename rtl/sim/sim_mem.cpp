@@ -0,0 +1,154 @@
+// sim_mem.cpp
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+#include "sim_mem.h"
+#include "sim_elf.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// The memory array is accessed as 16-bit words by the SDRAM models and as
+// bytes by the loader, which assumes a little-endian host (like the target).
+
+uint16_t *sim_mem_alloc(size_t size)
+{
+    void *p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return p == MAP_FAILED ? nullptr : (uint16_t *)p;
+}
+
+void sim_mem_clear(uint16_t *mem, size_t size)
+{
+    // Map fresh anonymous pages over the array; they read as zero and are
+    // only materialized when touched
+    void *p = mmap(mem, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+    if (p == MAP_FAILED)
+        memset(mem, 0, size);
+}
+
+void sim_mem_free(uint16_t *mem, size_t size)
+{
+    munmap(mem, size);
+}
+
+static long load_elf(uint8_t *mem, size_t size, const uint8_t *data, size_t len)
+{
+    if (len < sizeof(elf32_ehdr))
+        return -1;
+
+    elf32_ehdr ehdr;
+    memcpy(&ehdr, data, sizeof(ehdr));
+    if (ehdr.e_ident[4] != ELFCLASS32) {
+        fprintf(stderr, "Only ELF32 images are supported\n");
+        return -1;
+    }
+
+    long loaded = 0;
+    for (int i = 0; i < ehdr.e_phnum; ++i) {
+        size_t off = ehdr.e_phoff + (size_t)i * ehdr.e_phentsize;
+        if (off + sizeof(elf32_phdr) > len)
+            return -1;
+        elf32_phdr phdr;
+        memcpy(&phdr, data + off, sizeof(phdr));
+        if (phdr.p_type != PT_LOAD || phdr.p_memsz == 0)
+            continue;
+        if (phdr.p_filesz > phdr.p_memsz) {
+            fprintf(stderr, "ELF segment at 0x%x is larger in the file than in memory\n", phdr.p_paddr);
+            return -1;
+        }
+        if ((size_t)phdr.p_paddr + phdr.p_memsz > size ||
+            (size_t)phdr.p_offset + phdr.p_filesz > len) {
+            fprintf(stderr, "ELF segment at 0x%x does not fit in memory\n", phdr.p_paddr);
+            return -1;
+        }
+        memcpy(mem + phdr.p_paddr, data + phdr.p_offset, phdr.p_filesz);
+        // Zero-fill the remainder of the segment (.bss)
+        memset(mem + phdr.p_paddr + phdr.p_filesz, 0, phdr.p_memsz - phdr.p_filesz);
+        loaded += phdr.p_filesz;
+    }
+
+    return loaded;
+}
+
+static long load_hex(uint8_t *mem, size_t size, const uint8_t *data, size_t len)
+{
+    size_t addr = 0;
+    size_t i = 0;
+    while (i < len) {
+        uint32_t v = 0;
+        bool digits = false;
+        while (i < len && isxdigit(data[i])) {
+            int c = data[i++];
+            v = (v << 4) | (uint32_t)(c <= '9' ? c - '0' : (c | 0x20) - 'a' + 10);
+            digits = true;
+        }
+        while (i < len && (data[i] == '\r' || data[i] == '\n' || data[i] == ' '))
+            i++;
+        if (!digits) {
+            if (i < len) {
+                fprintf(stderr, "Invalid character in hex file\n");
+                return -1;
+            }
+            break;
+        }
+        if (addr + 4 > size)
+            return -1;
+        memcpy(mem + addr, &v, 4);
+        addr += 4;
+    }
+
+    return (long)addr;
+}
+
+long sim_mem_load_program(uint16_t *mem, size_t size, const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        close(fd);
+        fprintf(stderr, "%s: empty or unreadable file\n", path);
+        return -1;
+    }
+
+    size_t len = (size_t)st.st_size;
+    void *p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror(path);
+        return -1;
+    }
+
+    const uint8_t *data = (const uint8_t *)p;
+    uint8_t *mem8 = (uint8_t *)mem;
+    long loaded;
+
+    const char *ext = strrchr(path, '.');
+    if (elf_is_elf(data, len)) {
+        loaded = load_elf(mem8, size, data, len);
+    } else if (ext && !strcmp(ext, ".hex")) {
+        loaded = load_hex(mem8, size, data, len);
+    } else if (len <= size) {
+        memcpy(mem8, data, len);
+        loaded = (long)len;
+    } else {
+        loaded = -1;
+    }
+
+    munmap(p, len);
+
+    if (loaded < 0)
+        fprintf(stderr, "%s: unable to load program\n", path);
+
+    return loaded;
+}
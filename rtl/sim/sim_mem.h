@@ -0,0 +1,28 @@
+// sim_mem.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// SDRAM memory array of the simulator and program loader.
+
+#ifndef SIM_MEM_H
+#define SIM_MEM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Allocate a zero-filled memory array of the given size in bytes.
+uint16_t *sim_mem_alloc(size_t size);
+
+// Zero-fill the memory array. The pages are replaced by fresh ones, so the
+// cost does not depend on the size of the array.
+void sim_mem_clear(uint16_t *mem, size_t size);
+
+void sim_mem_free(uint16_t *mem, size_t size);
+
+// Load a program into the memory array: ELF (loadable segments, .bss
+// zero-filled), .hex (one 32-bit word per line, as generated by makehex.py)
+// or raw binary loaded at address 0.
+// Returns the number of bytes loaded, or -1 on error.
+long sim_mem_load_program(uint16_t *mem, size_t size, const char *path);
+
+#endif  // SIM_MEM_H
@@ -0,0 +1,208 @@
+// sim_perf.cpp
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+#include "sim_perf.h"
+#include "sim_rtl.h"
+
+#include <cstring>
+
+static const char *master_names[SIM_PERF_NB_MASTERS] = {"video", "cache", "graphite"};
+
+static double ratio(uint64_t a, uint64_t b)
+{
+    return b ? (double)a / (double)b : 0.0;
+}
+
+static sim_perf_counters_t delta(const sim_perf_counters_t &a, const sim_perf_counters_t &b)
+{
+    sim_perf_counters_t d;
+    const uint64_t *pa = (const uint64_t *)&a;
+    const uint64_t *pb = (const uint64_t *)&b;
+    uint64_t *pd = (uint64_t *)&d;
+    for (size_t i = 0; i < sizeof(d) / sizeof(uint64_t); ++i)
+        pd[i] = pa[i] - pb[i];
+    return d;
+}
+
+static void write_csv_row(FILE *f, const char *sample, const sim_perf_counters_t &c, uint64_t cycle)
+{
+    fprintf(f, "%s,%llu,%llu,%llu,%.4f,%.4f,%llu,%llu,%llu,%.4f",
+            sample, (unsigned long long)cycle, (unsigned long long)c.cycles,
+            (unsigned long long)c.instrs, ratio(c.cycles, c.instrs), ratio(c.stalls, c.cycles),
+            (unsigned long long)c.cache_hits, (unsigned long long)c.cache_misses,
+            (unsigned long long)c.cache_writebacks, ratio(c.cache_misses, c.cache_hits + c.cache_misses));
+    for (int i = 0; i < SIM_PERF_NB_MASTERS; ++i)
+        fprintf(f, ",%.4f,%llu", ratio(c.sdram_busy[i], c.sdram_cycles), (unsigned long long)c.sdram_bytes[i]);
+    fprintf(f, ",%llu,%llu,%.4f\n", (unsigned long long)c.video_low, (unsigned long long)c.video_underruns,
+            ratio(c.graphite_busy, c.cycles));
+}
+
+static void write_json_object(FILE *f, const sim_perf_counters_t &c, uint64_t cycle)
+{
+    fprintf(f, "{\"cycle\": %llu, \"cycles\": %llu, \"instrs\": %llu, \"cpi\": %.4f, \"stall_ratio\": %.4f, "
+               "\"cache_hits\": %llu, \"cache_misses\": %llu, \"cache_writebacks\": %llu, \"cache_miss_rate\": %.4f, "
+               "\"sdram\": {",
+            (unsigned long long)cycle, (unsigned long long)c.cycles, (unsigned long long)c.instrs,
+            ratio(c.cycles, c.instrs), ratio(c.stalls, c.cycles),
+            (unsigned long long)c.cache_hits, (unsigned long long)c.cache_misses,
+            (unsigned long long)c.cache_writebacks, ratio(c.cache_misses, c.cache_hits + c.cache_misses));
+    for (int i = 0; i < SIM_PERF_NB_MASTERS; ++i)
+        fprintf(f, "%s\"%s\": {\"utilization\": %.4f, \"bursts\": %llu, \"bytes\": %llu}", i ? ", " : "",
+                master_names[i], ratio(c.sdram_busy[i], c.sdram_cycles),
+                (unsigned long long)c.sdram_bursts[i], (unsigned long long)c.sdram_bytes[i]);
+    fprintf(f, "}, \"video_low\": %llu, \"video_underruns\": %llu, \"graphite_busy_ratio\": %.4f}",
+            (unsigned long long)c.video_low, (unsigned long long)c.video_underruns, ratio(c.graphite_busy, c.cycles));
+}
+
+static void write_sample(sim_perf_t *p)
+{
+    sim_perf_counters_t d = delta(p->total, p->last);
+    if (p->json) {
+        fprintf(p->f, "%s\n    ", p->nb_samples ? "," : "");
+        write_json_object(p->f, d, p->total.cycles);
+    } else {
+        char sample[24];
+        snprintf(sample, sizeof(sample), "%llu", (unsigned long long)p->nb_samples);
+        write_csv_row(p->f, sample, d, p->total.cycles);
+    }
+    p->nb_samples++;
+    p->last = p->total;
+}
+
+bool sim_perf_open(sim_perf_t *p, const char *path, uint64_t interval)
+{
+    memset(p, 0, sizeof(*p));
+    p->interval = interval;
+
+    if (!path)
+        return true;
+
+    p->f = fopen(path, "w");
+    if (!p->f) {
+        perror(path);
+        return false;
+    }
+
+    size_t len = strlen(path);
+    p->json = len >= 5 && !strcmp(path + len - 5, ".json");
+
+    if (p->json) {
+        fprintf(p->f, "{\n  \"interval\": %llu,\n  \"samples\": [", (unsigned long long)interval);
+    } else {
+        fprintf(p->f, "sample,cycle,cycles,instrs,cpi,stall_ratio,cache_hits,cache_misses,cache_writebacks,cache_miss_rate");
+        for (int i = 0; i < SIM_PERF_NB_MASTERS; ++i)
+            fprintf(p->f, ",sdram_%s_utilization,sdram_%s_bytes", master_names[i], master_names[i]);
+        fprintf(p->f, ",video_low,video_underruns,graphite_busy_ratio\n");
+    }
+
+    return true;
+}
+
+void sim_perf_cpu_posedge(sim_perf_t *p, Vtop *top)
+{
+    sim_perf_counters_t *c = &p->total;
+
+    c->cycles++;
+
+    if (top->cpu_ce_o) {
+        if (top->cpu_state_o & CPU_STATE_EXECUTE)
+            c->instrs++;
+    } else {
+        c->stalls++;
+    }
+
+    // The cache serves whatever address is on the bus, but only the cycles
+    // where the CPU (read strobe or write mask) or Graphite does request it
+    // count as hits. A miss starts a line fill in any case.
+    if (top->perf_cache_state_o == CACHE_IDLE && top->perf_cache_mreq_o) {
+        if (top->perf_cache_hit_o) {
+            if (top->perf_cache_req_o)
+                c->cache_hits++;
+        } else if (!top->perf_cache_flush_o) {
+            c->cache_misses++;
+        }
+    }
+    if (top->perf_cache_state_o == CACHE_WRITEBACK && p->cache_state != CACHE_WRITEBACK) {
+        if (p->cache_flush)
+            c->cache_flushes++;
+        else
+            c->cache_writebacks++;
+    }
+    p->cache_state = top->perf_cache_state_o;
+    p->cache_flush = top->perf_cache_flush_o;
+
+    if (top->perf_video_almost_empty_o)
+        c->video_low++;
+    if (top->perf_video_underrun_o)
+        c->video_underruns++;
+    if (top->perf_graphite_busy_o)
+        c->graphite_busy++;
+
+    if (p->f && p->interval && c->cycles % p->interval == 0)
+        write_sample(p);
+}
+
+void sim_perf_sdram_posedge(sim_perf_t *p, Vtop *top)
+{
+    sim_perf_counters_t *c = &p->total;
+    uint8_t ack = top->perf_sdram_cmd_ack_o;
+
+    c->sdram_cycles++;
+
+    if (ack) {
+        // Cache line fills and write-backs on behalf of Graphite are
+        // accounted to Graphite
+        int m = ack == CMD_READ_32 ? SIM_PERF_VIDEO :
+                top->perf_graphite_mem_o ? SIM_PERF_GRAPHITE : SIM_PERF_CACHE;
+        c->sdram_busy[m]++;
+        if (ack != p->sdram_ack) {
+            c->sdram_bursts[m]++;
+            c->sdram_bytes[m] += ack == CMD_READ_32 ? 32 : 256;
+        }
+    }
+    p->sdram_ack = ack;
+}
+
+void sim_perf_close(sim_perf_t *p)
+{
+    const sim_perf_counters_t &c = p->total;
+
+    printf("Performance counters:\n");
+    printf("  cycles: %llu, instructions: %llu, CPI: %.3f, stalls: %.1f%%\n",
+           (unsigned long long)c.cycles, (unsigned long long)c.instrs,
+           ratio(c.cycles, c.instrs), 100.0 * ratio(c.stalls, c.cycles));
+    printf("  cache: %llu hits, %llu misses (%.2f%%), %llu write-backs, %llu flushed lines\n",
+           (unsigned long long)c.cache_hits, (unsigned long long)c.cache_misses,
+           100.0 * ratio(c.cache_misses, c.cache_hits + c.cache_misses),
+           (unsigned long long)c.cache_writebacks, (unsigned long long)c.cache_flushes);
+    uint64_t busy = 0;
+    for (int i = 0; i < SIM_PERF_NB_MASTERS; ++i)
+        busy += c.sdram_busy[i];
+    printf("  sdram: %.1f%% busy", 100.0 * ratio(busy, c.sdram_cycles));
+    for (int i = 0; i < SIM_PERF_NB_MASTERS; ++i)
+        printf(", %s %.1f%% (%llu bytes)", master_names[i], 100.0 * ratio(c.sdram_busy[i], c.sdram_cycles),
+               (unsigned long long)c.sdram_bytes[i]);
+    printf("\n");
+    printf("  video: %llu cycles below threshold, %llu underruns\n",
+           (unsigned long long)c.video_low, (unsigned long long)c.video_underruns);
+    printf("  graphite: %.1f%% busy\n", 100.0 * ratio(c.graphite_busy, c.cycles));
+
+    if (!p->f)
+        return;
+
+    // Partial last sample, then the totals
+    if (c.cycles != p->last.cycles)
+        write_sample(p);
+
+    if (p->json) {
+        fprintf(p->f, "\n  ],\n  \"summary\": ");
+        write_json_object(p->f, c, c.cycles);
+        fprintf(p->f, "\n}\n");
+    } else {
+        write_csv_row(p->f, "total", c, c.cycles);
+    }
+
+    fclose(p->f);
+    p->f = nullptr;
+}
@@ -0,0 +1,66 @@
+// sim_perf.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// Performance counters. Samples internal signals of the SoC exported by
+// top.sv (PERF) every cycle and reports the CPI, the cache miss rate, the
+// SDRAM bandwidth split between video, cache and Graphite and the video
+// FIFO underruns, as a summary and as a time series (CSV or JSON).
+
+#ifndef SIM_PERF_H
+#define SIM_PERF_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "Vtop.h"
+
+// SDRAM requesters
+#define SIM_PERF_VIDEO      0
+#define SIM_PERF_CACHE      1
+#define SIM_PERF_GRAPHITE   2
+#define SIM_PERF_NB_MASTERS 3
+
+struct sim_perf_counters_t {
+    uint64_t cycles;            // CPU cycles
+    uint64_t instrs;            // instructions executed
+    uint64_t stalls;            // cycles with the CPU clock enable low
+    uint64_t cache_hits;
+    uint64_t cache_misses;
+    uint64_t cache_writebacks;  // misses evicting a dirty line
+    uint64_t cache_flushes;     // lines written back by a flush
+    uint64_t sdram_cycles;      // clk_sdram cycles
+    uint64_t sdram_busy[SIM_PERF_NB_MASTERS];   // cycles with a command acknowledged
+    uint64_t sdram_bursts[SIM_PERF_NB_MASTERS];
+    uint64_t sdram_bytes[SIM_PERF_NB_MASTERS];
+    uint64_t video_low;         // cycles with the video queue below its threshold
+    uint64_t video_underruns;   // pixel reads from an empty video queue
+    uint64_t graphite_busy;     // cycles with Graphite not ready for commands
+};
+
+struct sim_perf_t {
+    FILE *f;                    // time series, nullptr if none
+    bool json;
+    uint64_t interval;          // CPU cycles per sample
+    uint64_t nb_samples;
+    sim_perf_counters_t total;
+    sim_perf_counters_t last;   // totals at the previous sample
+    uint8_t cache_state;
+    bool cache_flush;
+    uint8_t sdram_ack;
+};
+
+// path may be nullptr to only print the summary. The format of the time
+// series is JSON if path ends with ".json", CSV otherwise.
+bool sim_perf_open(sim_perf_t *p, const char *path, uint64_t interval);
+
+// To be called before evaluating each positive edge of clk
+void sim_perf_cpu_posedge(sim_perf_t *p, Vtop *top);
+
+// To be called before evaluating each positive edge of clk_sdram
+void sim_perf_sdram_posedge(sim_perf_t *p, Vtop *top);
+
+// Prints the summary and completes the time series
+void sim_perf_close(sim_perf_t *p);
+
+#endif  // SIM_PERF_H
@@ -0,0 +1,190 @@
+// sim_prof.cpp
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+#include "sim_prof.h"
+#include "sim_elf.h"
+#include "sim_rtl.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+// Opcodes
+#define OP_JAL      0x6F
+#define OP_JALR     0x67
+
+// Link registers (ra, t0) of the calling convention
+#define IS_LINK(r) ((r) == 1 || (r) == 5)
+
+static void load_symbols(sim_prof_t *p, const char *path)
+{
+    elf_for_each_symbol(path, [p](const elf32_sym &sym, const char *name, size_t name_len) {
+        if (ELF32_ST_TYPE(sym.st_info) == STT_FUNC)
+            p->symbols.push_back({sym.st_value & ~1u, sym.st_size, std::string(name, name_len)});
+        return true;
+    });
+
+    // Aliases without a size come first so that lookups find the sized one
+    std::sort(p->symbols.begin(), p->symbols.end(),
+              [](const sim_prof_symbol_t &a, const sim_prof_symbol_t &b) {
+                  return a.addr < b.addr || (a.addr == b.addr && a.size < b.size);
+              });
+}
+
+// Index of the function containing addr, -1 if none
+static int find_symbol(sim_prof_t *p, uint32_t addr)
+{
+    if (p->last_symbol >= 0) {
+        const sim_prof_symbol_t &s = p->symbols[p->last_symbol];
+        if (addr >= s.addr && addr - s.addr < s.size)
+            return p->last_symbol;
+    }
+
+    auto it = std::upper_bound(p->symbols.begin(), p->symbols.end(), addr,
+                               [](uint32_t a, const sim_prof_symbol_t &s) { return a < s.addr; });
+    if (it == p->symbols.begin())
+        return -1;
+    --it;
+    // Symbols without a size extend up to the next one
+    if (it->size && addr - it->addr >= it->size)
+        return -1;
+    p->last_symbol = (int)(it - p->symbols.begin());
+    return p->last_symbol;
+}
+
+static std::string symbol_name(sim_prof_t *p, int index, uint32_t addr)
+{
+    if (index >= 0)
+        return p->symbols[index].name;
+    char s[16];
+    snprintf(s, sizeof(s), "0x%08x", addr);
+    return s;
+}
+
+static void record(sim_prof_t *p, uint32_t pc)
+{
+    p->nb_samples++;
+    p->pc_counts[pc]++;
+
+    std::vector<int> key(p->stack);
+    key.push_back(find_symbol(p, pc));
+    p->stack_counts[key]++;
+}
+
+bool sim_prof_open(sim_prof_t *p, const char *prefix, const char *elf_path, uint64_t interval)
+{
+    *p = sim_prof_t();
+    p->prefix = prefix;
+    p->interval = interval;
+    p->last_symbol = -1;
+
+    if (elf_path)
+        load_symbols(p, elf_path);
+    if (p->symbols.empty())
+        fprintf(stderr, "Profiler: no symbols found%s%s, reporting addresses\n",
+                elf_path ? " in " : "", elf_path ? elf_path : "");
+
+    return true;
+}
+
+void sim_prof_posedge(sim_prof_t *p, Vtop *top)
+{
+    p->cycles++;
+
+    uint8_t state = top->cpu_state_o;
+    bool execute = top->cpu_ce_o && (state & CPU_STATE_EXECUTE);
+
+    if (p->interval && p->cycles % p->interval == 0) {
+        // While waiting for the ALU or memory, PC already holds the next
+        // instruction: charge the cycles to the one being completed
+        bool waiting = state & (CPU_STATE_WAIT_ALU_OR_MEM | CPU_STATE_WAIT_ALU_OR_MEM_SKIP);
+        record(p, waiting ? p->last_pc : top->cpu_pc_o);
+    }
+
+    if (!execute)
+        return;
+
+    uint32_t pc = top->cpu_pc_o;
+    uint32_t instr = top->prof_instr_o;
+    p->last_pc = pc;
+
+    if (!p->interval)
+        record(p, pc);
+
+    uint32_t opcode = instr & 0x7F;
+    uint32_t rd = (instr >> 7) & 0x1F;
+    uint32_t rs1 = (instr >> 15) & 0x1F;
+    if ((opcode == OP_JAL || opcode == OP_JALR) && IS_LINK(rd)) {
+        // Call
+        if (p->stack.size() < SIM_PROF_MAX_DEPTH)
+            p->stack.push_back(find_symbol(p, pc));
+        else
+            p->overflow++;
+    } else if (opcode == OP_JALR && rd == 0 && IS_LINK(rs1) && (instr >> 20) == 0) {
+        // Return
+        if (p->overflow)
+            p->overflow--;
+        else if (!p->stack.empty())
+            p->stack.pop_back();
+    }
+}
+
+void sim_prof_close(sim_prof_t *p)
+{
+    std::string path = p->prefix + ".folded";
+    FILE *f = fopen(path.c_str(), "w");
+    if (f) {
+        for (const auto &it : p->stack_counts) {
+            const std::vector<int> &key = it.first;
+            for (size_t i = 0; i < key.size(); ++i)
+                fprintf(f, "%s%s", i ? ";" : "", key[i] >= 0 ? p->symbols[key[i]].name.c_str() : "[unknown]");
+            fprintf(f, " %llu\n", (unsigned long long)it.second);
+        }
+        fclose(f);
+    } else {
+        perror(path.c_str());
+    }
+
+    // Self counts per function; unknown addresses are kept separate
+    std::map<std::string, uint64_t> funcs;
+    std::vector<std::pair<uint32_t, uint64_t>> pcs(p->pc_counts.begin(), p->pc_counts.end());
+    std::sort(pcs.begin(), pcs.end());
+    path = p->prefix + ".pcs";
+    f = fopen(path.c_str(), "w");
+    if (!f)
+        perror(path.c_str());
+    for (const auto &it : pcs) {
+        int index = find_symbol(p, it.first);
+        std::string name = symbol_name(p, index, it.first);
+        funcs[name] += it.second;
+        if (f && index >= 0)
+            fprintf(f, "0x%08x %llu %s+0x%x\n", it.first, (unsigned long long)it.second, name.c_str(),
+                    it.first - p->symbols[index].addr);
+        else if (f)
+            fprintf(f, "0x%08x %llu\n", it.first, (unsigned long long)it.second);
+    }
+    if (f)
+        fclose(f);
+
+    std::vector<std::pair<uint64_t, std::string>> sorted;
+    for (const auto &it : funcs)
+        sorted.emplace_back(it.second, it.first);
+    std::sort(sorted.begin(), sorted.end(), std::greater<std::pair<uint64_t, std::string>>());
+
+    path = p->prefix + ".funcs";
+    f = fopen(path.c_str(), "w");
+    if (!f)
+        perror(path.c_str());
+    printf("Profile: %llu samples (%s)\n", (unsigned long long)p->nb_samples,
+           p->interval ? "cycles" : "instructions");
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        double pct = 100.0 * sorted[i].first / (p->nb_samples ? p->nb_samples : 1);
+        if (f)
+            fprintf(f, "%12llu %6.2f%% %s\n", (unsigned long long)sorted[i].first, pct, sorted[i].second.c_str());
+        if (i < 10)
+            printf("  %6.2f%% %s\n", pct, sorted[i].second.c_str());
+    }
+    if (f)
+        fclose(f);
+}
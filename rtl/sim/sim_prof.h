@@ -0,0 +1,61 @@
+// sim_prof.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// PC profiler. Either samples the processor PC every <interval> cycles
+// (including the cycles spent waiting for the cache or the ALU) or counts
+// every executed instruction, and keeps a shadow call stack built from the
+// calls and returns executed. The samples are resolved against the ELF
+// symbols and written as:
+//   <prefix>.folded   folded stacks (input of flamegraph.pl)
+//   <prefix>.funcs    per-function histogram
+//   <prefix>.pcs      per-address histogram (see utils/prof_lines.py)
+
+#ifndef SIM_PROF_H
+#define SIM_PROF_H
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Vtop.h"
+
+#define SIM_PROF_MAX_DEPTH 256
+
+struct sim_prof_symbol_t {
+    uint32_t addr;
+    uint32_t size;
+    std::string name;
+};
+
+struct sim_prof_t {
+    std::string prefix;
+    uint64_t interval;          // 0: count every executed instruction
+    uint64_t cycles;
+    uint64_t nb_samples;
+
+    std::vector<sim_prof_symbol_t> symbols;     // sorted by address
+    int last_symbol;            // lookup cache
+
+    uint32_t last_pc;           // last executed instruction
+    std::vector<int> stack;     // caller functions (symbol indices)
+    int overflow;               // calls not pushed beyond SIM_PROF_MAX_DEPTH
+
+    std::unordered_map<uint32_t, uint64_t> pc_counts;
+    std::map<std::vector<int>, uint64_t> stack_counts;     // stack + leaf
+};
+
+// elf_path may be nullptr or not an ELF file, addresses are then reported
+// without symbols
+bool sim_prof_open(sim_prof_t *p, const char *prefix, const char *elf_path, uint64_t interval);
+
+// To be called before evaluating each positive edge of clk
+void sim_prof_posedge(sim_prof_t *p, Vtop *top);
+
+// Writes the profiles
+void sim_prof_close(sim_prof_t *p);
+
+#endif  // SIM_PROF_H
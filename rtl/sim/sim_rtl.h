@@ -0,0 +1,33 @@
+// sim_rtl.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// Encodings of the RTL signals sampled by the simulator
+
+#ifndef SIM_RTL_H
+#define SIM_RTL_H
+
+// CPU clock, passed by the Makefile to both the model (FREQ_HZ of soc_top)
+// and the simulator
+#ifndef CPU_FREQ_HZ
+#error "CPU_FREQ_HZ is not defined"
+#endif
+
+// Processor states (one-hot, see processor.v)
+#define CPU_STATE_FETCH_INSTR           (1 << 0)
+#define CPU_STATE_WAIT_INSTR            (1 << 1)
+#define CPU_STATE_DECOMPRESS_GETREGS    (1 << 2)
+#define CPU_STATE_EXECUTE               (1 << 3)
+#define CPU_STATE_WAIT_ALU_OR_MEM       (1 << 4)
+#define CPU_STATE_WAIT_ALU_OR_MEM_SKIP  (1 << 5)
+
+// Cache controller states (cache_controller.v)
+#define CACHE_IDLE          0
+#define CACHE_WRITEBACK     3
+
+// SDRAM commands (sys_cmd, sys_cmd_ack)
+#define CMD_WRITE_256       1
+#define CMD_READ_32         2
+#define CMD_READ_256        3
+
+#endif  // SIM_RTL_H
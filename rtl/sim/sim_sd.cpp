@@ -0,0 +1,326 @@
+// sim_sd.cpp
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+#include "sim_sd.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// R1 response bits
+#define R1_IDLE             0x01
+#define R1_ILLEGAL_COMMAND  0x04
+#define R1_ADDRESS_ERROR    0x20
+
+// Data tokens
+#define TOKEN_START         0xFE    // single block read/write, multiple block read
+#define TOKEN_START_MULTI   0xFC    // multiple block write
+#define TOKEN_STOP_TRAN     0xFD    // end of multiple block write
+#define DATA_ACCEPTED       0x05
+
+bool sim_sd_open(sim_sd_t *sd, const char *path, int latency)
+{
+    *sd = sim_sd_t();
+    sd->latency = latency;
+    sd->out_shift = 0xFF;
+    sd->idle = true;
+
+    if (!path)
+        return true;
+
+    bool read_only = false;
+    int fd = open(path, O_RDWR);
+    if (fd < 0) {
+        fd = open(path, O_RDONLY);
+        read_only = true;
+    }
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror(path);
+        if (fd >= 0)
+            close(fd);
+        return false;
+    }
+    sd->size = (size_t)st.st_size / SIM_SD_BLOCK_LEN * SIM_SD_BLOCK_LEN;
+    if (sd->size == 0) {
+        fprintf(stderr, "%s: SD card image smaller than one block\n", path);
+        close(fd);
+        return false;
+    }
+
+    // Writes go to the file, or to private pages for a read-only image
+    void *p = mmap(nullptr, sd->size, PROT_READ | PROT_WRITE, read_only ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror(path);
+        return false;
+    }
+    sd->image = (uint8_t *)p;
+
+    return true;
+}
+
+static uint8_t r1(sim_sd_t *sd, uint8_t flags)
+{
+    return (sd->idle ? R1_IDLE : 0) | flags;
+}
+
+static void push_block(sim_sd_t *sd)
+{
+    for (int i = 0; i < sd->latency; ++i)
+        sd->out.push_back(0xFF);
+    sd->out.push_back(TOKEN_START);
+    const uint8_t *p = sd->image + (size_t)sd->block * SIM_SD_BLOCK_LEN;
+    sd->out.insert(sd->out.end(), p, p + SIM_SD_BLOCK_LEN);
+    sd->out.push_back(0xFF);    // CRC, not checked in SPI mode
+    sd->out.push_back(0xFF);
+    sd->block++;
+    sd->blocks_read++;
+}
+
+static void push_busy(sim_sd_t *sd)
+{
+    for (int i = 0; i < sd->latency; ++i)
+        sd->out.push_back(0x00);
+}
+
+static bool valid_block(sim_sd_t *sd, uint32_t block)
+{
+    return (uint64_t)block * SIM_SD_BLOCK_LEN < sd->size;
+}
+
+static void execute(sim_sd_t *sd)
+{
+    uint8_t index = sd->cmd[0] & 0x3F;
+    uint32_t arg = (uint32_t)sd->cmd[1] << 24 | (uint32_t)sd->cmd[2] << 16 | (uint32_t)sd->cmd[3] << 8 | sd->cmd[4];
+    bool app_cmd = sd->app_cmd;
+    sd->app_cmd = false;
+
+    sd->out.clear();
+    sd->out.push_back(0xFF);    // NCR
+
+    if (app_cmd && index == 41) {
+        // ACMD41: the initialization completes on the second attempt
+        if (++sd->op_cond_count >= 2)
+            sd->idle = false;
+        sd->out.push_back(r1(sd, 0));
+        return;
+    }
+
+    switch (index) {
+    case 0:
+        sd->idle = true;
+        sd->op_cond_count = 0;
+        sd->multi_read = false;
+        sd->out.push_back(r1(sd, 0));
+        break;
+    case 8:
+        // R7: voltage accepted, check pattern echoed
+        sd->out.push_back(r1(sd, 0));
+        sd->out.push_back(0x00);
+        sd->out.push_back(0x00);
+        sd->out.push_back((uint8_t)(arg >> 8) & 0x0F);
+        sd->out.push_back((uint8_t)arg);
+        break;
+    case 12:
+        sd->multi_read = false;
+        sd->out.push_back(0xFF);    // stuff byte
+        sd->out.push_back(r1(sd, 0));
+        break;
+    case 16:
+    case 55:
+        sd->app_cmd = index == 55;
+        sd->out.push_back(r1(sd, 0));
+        break;
+    case 17:
+    case 18:
+        if (sd->idle || !valid_block(sd, arg)) {
+            sd->out.push_back(r1(sd, sd->idle ? R1_ILLEGAL_COMMAND : R1_ADDRESS_ERROR));
+            break;
+        }
+        sd->out.push_back(r1(sd, 0));
+        sd->block = arg;
+        sd->multi_read = index == 18;
+        push_block(sd);
+        break;
+    case 24:
+    case 25:
+        if (sd->idle || !valid_block(sd, arg)) {
+            sd->out.push_back(r1(sd, sd->idle ? R1_ILLEGAL_COMMAND : R1_ADDRESS_ERROR));
+            break;
+        }
+        sd->out.push_back(r1(sd, 0));
+        sd->block = arg;
+        sd->writing = true;
+        sd->multi_write = index == 25;
+        sd->data_len = -1;
+        break;
+    case 58:
+        // R3: OCR with power up status and CCS (SDHC) set, 2.7-3.6V
+        sd->out.push_back(r1(sd, 0));
+        sd->out.push_back(0xC0);
+        sd->out.push_back(0xFF);
+        sd->out.push_back(0x80);
+        sd->out.push_back(0x00);
+        break;
+    default:
+        sd->out.push_back(r1(sd, R1_ILLEGAL_COMMAND));
+        break;
+    }
+}
+
+static void write_byte(sim_sd_t *sd, uint8_t in)
+{
+    if (sd->data_len < 0) {
+        if (in == (sd->multi_write ? TOKEN_START_MULTI : TOKEN_START)) {
+            sd->data_len = 0;
+        } else if (sd->multi_write && in == TOKEN_STOP_TRAN) {
+            sd->writing = false;
+            sd->out.push_back(0xFF);
+            push_busy(sd);
+        }
+        return;
+    }
+
+    sd->data[sd->data_len++] = in;
+    if (sd->data_len < SIM_SD_BLOCK_LEN + 2)
+        return;
+
+    if (valid_block(sd, sd->block)) {
+        memcpy(sd->image + (size_t)sd->block * SIM_SD_BLOCK_LEN, sd->data, SIM_SD_BLOCK_LEN);
+        sd->blocks_written++;
+    }
+    sd->block++;
+    sd->out.push_back(DATA_ACCEPTED | 0xE0);
+    push_busy(sd);
+    sd->data_len = -1;
+    if (!sd->multi_write)
+        sd->writing = false;
+}
+
+// Byte exchange: returns the byte to send back during the next transfer
+static uint8_t transfer(sim_sd_t *sd, uint8_t in)
+{
+    if (sd->writing) {
+        write_byte(sd, in);
+    } else if (sd->cmd_len > 0 || (in & 0xC0) == 0x40) {
+        sd->cmd[sd->cmd_len++] = in;
+        if (sd->cmd_len == 6) {
+            sd->cmd_len = 0;
+            execute(sd);
+        }
+    }
+
+    if (sd->multi_read && sd->out.empty()) {
+        if (valid_block(sd, sd->block))
+            push_block(sd);
+        else
+            sd->multi_read = false;
+    }
+
+    if (sd->out.empty())
+        return 0xFF;
+    uint8_t out = sd->out.front();
+    sd->out.pop_front();
+    return out;
+}
+
+void sim_sd_posedge(sim_sd_t *sd, Vtop *top)
+{
+    if (!sd->image) {
+        top->sd_do_i = 1;
+        return;
+    }
+
+    if (top->sd_cs_n_o) {
+        // Deselected: abort the byte and any data transfer in progress
+        sd->bit_count = 0;
+        sd->cmd_len = 0;
+        sd->writing = false;
+        sd->multi_read = false;
+        sd->out.clear();
+        sd->out_shift = 0xFF;
+        sd->sck = top->sd_ck_o;
+        top->sd_do_i = 1;
+        return;
+    }
+
+    // Mode 0: sample MOSI on the rising edge, shift MISO on the falling edge
+    bool sck = top->sd_ck_o;
+    if (sck && !sd->sck) {
+        sd->in_shift = (uint8_t)((sd->in_shift << 1) | (top->sd_di_o & 1));
+        sd->bit_count++;
+    } else if (!sck && sd->sck) {
+        if (sd->bit_count == 8) {
+            sd->bit_count = 0;
+            sd->out_shift = transfer(sd, sd->in_shift);
+        } else {
+            sd->out_shift <<= 1;
+        }
+    }
+    sd->sck = sck;
+    top->sd_do_i = sd->out_shift >> 7;
+}
+
+void sim_sd_save(const sim_sd_t *sd, sim_sd_state_t *state, std::vector<uint8_t> *out)
+{
+    state->size = sd->image ? sd->size : 0;
+    state->sck = sd->sck;
+    state->bit_count = sd->bit_count;
+    state->in_shift = sd->in_shift;
+    state->out_shift = sd->out_shift;
+    state->idle = sd->idle;
+    state->app_cmd = sd->app_cmd;
+    state->op_cond_count = sd->op_cond_count;
+    memcpy(state->cmd, sd->cmd, sizeof(state->cmd));
+    state->cmd_len = sd->cmd_len;
+    state->multi_read = sd->multi_read;
+    state->writing = sd->writing;
+    state->multi_write = sd->multi_write;
+    state->data_len = sd->data_len;
+    state->block = sd->block;
+    memcpy(state->data, sd->data, sizeof(state->data));
+    state->out_len = (uint32_t)sd->out.size();
+    out->insert(out->end(), sd->out.begin(), sd->out.end());
+}
+
+bool sim_sd_restore(sim_sd_t *sd, const sim_sd_state_t *state, const uint8_t *out, size_t out_size)
+{
+    if (state->size != (sd->image ? sd->size : 0) || out_size != state->out_len)
+        return false;
+
+    sd->sck = state->sck;
+    sd->bit_count = state->bit_count;
+    sd->in_shift = state->in_shift;
+    sd->out_shift = state->out_shift;
+    sd->idle = state->idle;
+    sd->app_cmd = state->app_cmd;
+    sd->op_cond_count = state->op_cond_count;
+    memcpy(sd->cmd, state->cmd, sizeof(sd->cmd));
+    sd->cmd_len = state->cmd_len;
+    sd->multi_read = state->multi_read;
+    sd->writing = state->writing;
+    sd->multi_write = state->multi_write;
+    sd->data_len = state->data_len;
+    sd->block = state->block;
+    memcpy(sd->data, state->data, sizeof(sd->data));
+    sd->out.assign(out, out + out_size);
+
+    return true;
+}
+
+void sim_sd_close(sim_sd_t *sd)
+{
+    if (!sd->image)
+        return;
+
+    printf("SD card: %llu blocks read, %llu blocks written\n",
+           (unsigned long long)sd->blocks_read, (unsigned long long)sd->blocks_written);
+    munmap(sd->image, sd->size);
+    sd->image = nullptr;
+}
@@ -0,0 +1,89 @@
+// sim_sd.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// SD card in SPI mode (SDHC, block addressing), backed by a memory-mapped
+// host image file. Supports CMD0/8/12/16/17/18/24/25/55/58 and ACMD41.
+// Without an image, the card is absent (MISO stays high).
+
+#ifndef SIM_SD_H
+#define SIM_SD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+#include <vector>
+
+#include "Vtop.h"
+
+#define SIM_SD_BLOCK_LEN 512
+
+struct sim_sd_t {
+    uint8_t *image;             // nullptr if no card
+    size_t size;                // image size in bytes
+    int latency;                // bytes before a data block / of write busy
+
+    // SPI
+    bool sck;
+    int bit_count;
+    uint8_t in_shift;
+    uint8_t out_shift;
+
+    // Card
+    bool idle;
+    bool app_cmd;
+    int op_cond_count;
+    uint8_t cmd[6];
+    int cmd_len;
+    bool multi_read;
+    bool writing;               // waiting for or receiving data blocks
+    bool multi_write;
+    int data_len;               // bytes of the block being written (-1: wait token)
+    uint32_t block;             // next block to read/write
+    uint8_t data[SIM_SD_BLOCK_LEN + 2];
+    std::deque<uint8_t> out;    // bytes to send, 0xFF when empty
+
+    uint64_t blocks_read;
+    uint64_t blocks_written;
+};
+
+// SPI and card state, saved in a snapshot; the out_len bytes to send follow
+struct sim_sd_state_t {
+    uint64_t size;              // image size, 0 if no card
+    bool sck;
+    int bit_count;
+    uint8_t in_shift;
+    uint8_t out_shift;
+    bool idle;
+    bool app_cmd;
+    int op_cond_count;
+    uint8_t cmd[6];
+    int cmd_len;
+    bool multi_read;
+    bool writing;
+    bool multi_write;
+    int data_len;
+    uint32_t block;
+    uint8_t data[SIM_SD_BLOCK_LEN + 2];
+    uint32_t out_len;
+};
+
+// path may be nullptr for no card. The image is modified in place unless it
+// is read-only.
+bool sim_sd_open(sim_sd_t *sd, const char *path, int latency);
+
+// To be called before evaluating each positive edge of clk
+void sim_sd_posedge(sim_sd_t *sd, Vtop *top);
+
+// Appends the bytes to send to <out>
+void sim_sd_save(const sim_sd_t *sd, sim_sd_state_t *state, std::vector<uint8_t> *out);
+
+// The image itself is not part of the state. Returns false if the image
+// size differs from the saved one or if <out_size> does not match the saved
+// number of bytes to send
+bool sim_sd_restore(sim_sd_t *sd, const sim_sd_state_t *state, const uint8_t *out, size_t out_size);
+
+void sim_sd_close(sim_sd_t *sd);
+
+#endif  // SIM_SD_H
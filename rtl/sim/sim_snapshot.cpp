@@ -0,0 +1,246 @@
+// sim_snapshot.cpp
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+#include "sim_snapshot.h"
+#include "sim_mem.h"
+
+#include <verilated_save.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// File layout:
+//   header
+//   simulator state     (state_size bytes)
+//   model state         (model_size bytes, Verilator serialization)
+//   page map            (one byte per memory page, 1 if stored)
+//   padding
+//   stored pages        (from pages_offset, in address order)
+
+static const char snapshot_magic[8] = {'X', 'G', 'S', 'N', 'A', 'P', 0, 4};
+
+struct snapshot_header {
+    char     magic[8];
+    uint32_t page_size;
+    uint32_t nb_pages;      // pages in the memory array
+    uint32_t nb_stored;     // non-zero pages stored in the file
+    uint32_t reserved;
+    uint64_t state_size;
+    uint64_t model_size;
+    uint64_t pages_offset;
+};
+
+// Verilator serialization to/from memory buffers
+class snapshot_serialize : public VerilatedSerialize {
+    std::vector<uint8_t> &m_data;
+
+public:
+    explicit snapshot_serialize(std::vector<uint8_t> &data) : m_data(data)
+    {
+        m_isOpen = true;
+        header();
+    }
+    ~snapshot_serialize() override { close(); }
+    void close() override
+    {
+        if (!m_isOpen)
+            return;
+        trailer();
+        flush();
+        m_isOpen = false;
+    }
+    void flush() override
+    {
+        m_data.insert(m_data.end(), m_bufp, m_cp);
+        m_cp = m_bufp;
+    }
+};
+
+class snapshot_deserialize : public VerilatedDeserialize {
+    const uint8_t *m_srcp;
+    const uint8_t *m_src_endp;
+
+public:
+    snapshot_deserialize(const uint8_t *data, size_t size) : m_srcp(data), m_src_endp(data + size)
+    {
+        m_isOpen = true;
+        m_cp = m_bufp;
+        m_endp = m_bufp;
+        header();
+    }
+    ~snapshot_deserialize() override { close(); }
+    void close() override
+    {
+        if (!m_isOpen)
+            return;
+        trailer();
+        m_isOpen = false;
+    }
+
+protected:
+    void fill() override
+    {
+        size_t remaining = m_endp - m_cp;
+        memmove(m_bufp, m_cp, remaining);
+        m_cp = m_bufp;
+        m_endp = m_bufp + remaining;
+        size_t n = std::min((size_t)(m_bufp + bufferSize() - m_endp), (size_t)(m_src_endp - m_srcp));
+        memcpy(m_endp, m_srcp, n);
+        m_endp += n;
+        m_srcp += n;
+    }
+};
+
+static bool is_zero_page(const uint8_t *p)
+{
+    const uint64_t *w = (const uint64_t *)p;
+    for (size_t i = 0; i < SIM_SNAPSHOT_PAGE_SIZE / sizeof(uint64_t); ++i)
+        if (w[i])
+            return false;
+    return true;
+}
+
+bool sim_snapshot_save(const char *path, Vtop *top,
+                       const void *state, size_t state_size,
+                       const uint16_t *mem, size_t mem_size)
+{
+    std::vector<uint8_t> model;
+    {
+        snapshot_serialize os(model);
+        os << *top;
+    }
+
+    const uint8_t *mem8 = (const uint8_t *)mem;
+    uint32_t nb_pages = (uint32_t)(mem_size / SIM_SNAPSHOT_PAGE_SIZE);
+    std::vector<uint8_t> page_map(nb_pages);
+    uint32_t nb_stored = 0;
+    for (uint32_t i = 0; i < nb_pages; ++i) {
+        page_map[i] = !is_zero_page(mem8 + (size_t)i * SIM_SNAPSHOT_PAGE_SIZE);
+        nb_stored += page_map[i];
+    }
+
+    snapshot_header hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, snapshot_magic, sizeof(hdr.magic));
+    hdr.page_size = SIM_SNAPSHOT_PAGE_SIZE;
+    hdr.nb_pages = nb_pages;
+    hdr.nb_stored = nb_stored;
+    hdr.state_size = state_size;
+    hdr.model_size = model.size();
+    uint64_t end = sizeof(hdr) + state_size + model.size() + nb_pages;
+    hdr.pages_offset = (end + SIM_SNAPSHOT_PAGE_SIZE - 1) / SIM_SNAPSHOT_PAGE_SIZE * SIM_SNAPSHOT_PAGE_SIZE;
+
+    // Write to a temporary file first: a snapshot being mapped by another
+    // simulation must not be modified in place
+    std::string tmp_path = std::string(path) + ".tmp";
+    FILE *f = fopen(tmp_path.c_str(), "wb");
+    if (!f) {
+        perror(tmp_path.c_str());
+        return false;
+    }
+
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+    ok = ok && (!state_size || fwrite(state, state_size, 1, f) == 1);
+    ok = ok && fwrite(model.data(), model.size(), 1, f) == 1;
+    ok = ok && fwrite(page_map.data(), nb_pages, 1, f) == 1;
+    ok = ok && fseek(f, (long)hdr.pages_offset, SEEK_SET) == 0;
+    for (uint32_t i = 0; ok && i < nb_pages; ++i)
+        if (page_map[i])
+            ok = fwrite(mem8 + (size_t)i * SIM_SNAPSHOT_PAGE_SIZE, SIM_SNAPSHOT_PAGE_SIZE, 1, f) == 1;
+    ok = (fclose(f) == 0) && ok;
+
+    if (!ok || rename(tmp_path.c_str(), path) != 0) {
+        perror(path);
+        remove(tmp_path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool sim_snapshot_restore(const char *path, Vtop *top,
+                          std::vector<uint8_t> *state, size_t min_state_size,
+                          uint16_t *mem, size_t mem_size)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        perror(path);
+        return false;
+    }
+
+    struct stat st;
+    snapshot_header hdr;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(hdr) ||
+        pread(fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr) ||
+        memcmp(hdr.magic, snapshot_magic, sizeof(hdr.magic)) != 0) {
+        fprintf(stderr, "%s: not a snapshot file\n", path);
+        close(fd);
+        return false;
+    }
+
+    if (hdr.page_size != SIM_SNAPSHOT_PAGE_SIZE ||
+        (uint64_t)hdr.nb_pages * SIM_SNAPSHOT_PAGE_SIZE != mem_size ||
+        hdr.state_size < min_state_size ||
+        hdr.pages_offset + (uint64_t)hdr.nb_stored * SIM_SNAPSHOT_PAGE_SIZE > (uint64_t)st.st_size) {
+        fprintf(stderr, "%s: snapshot does not match this simulator build\n", path);
+        close(fd);
+        return false;
+    }
+
+    // Header, states and page map
+    size_t meta_size = (size_t)hdr.pages_offset;
+    void *meta = mmap(nullptr, meta_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (meta == MAP_FAILED) {
+        perror(path);
+        close(fd);
+        return false;
+    }
+    const uint8_t *p = (const uint8_t *)meta + sizeof(hdr);
+    state->assign(p, p + hdr.state_size);
+    p += hdr.state_size;
+    {
+        snapshot_deserialize is(p, (size_t)hdr.model_size);
+        is >> *top;
+    }
+    p += hdr.model_size;
+    const uint8_t *page_map = p;
+
+    // Memory pages: zero pages are fresh anonymous pages, the others are
+    // mapped copy-on-write from the file, one mapping per run of pages
+    sim_mem_clear(mem, mem_size);
+    uint8_t *mem8 = (uint8_t *)mem;
+    uint64_t offset = hdr.pages_offset;
+    bool ok = true;
+    for (uint32_t i = 0; ok && i < hdr.nb_pages;) {
+        if (!page_map[i]) {
+            i++;
+            continue;
+        }
+        uint32_t n = 1;
+        while (i + n < hdr.nb_pages && page_map[i + n])
+            n++;
+        size_t len = (size_t)n * SIM_SNAPSHOT_PAGE_SIZE;
+        void *q = mmap(mem8 + (size_t)i * SIM_SNAPSHOT_PAGE_SIZE, len, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_FIXED, fd, (off_t)offset);
+        ok = q != MAP_FAILED;
+        offset += len;
+        i += n;
+    }
+
+    munmap(meta, meta_size);
+    close(fd);
+
+    if (!ok)
+        perror(path);
+
+    return ok;
+}
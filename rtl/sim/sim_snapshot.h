@@ -0,0 +1,35 @@
+// sim_snapshot.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// Simulation snapshots (requires a model verilated with --savable).
+//
+// A snapshot file holds the Verilated model state, an opaque variable-length
+// simulator state and the non-zero pages of the memory array. The pages are stored aligned on
+// SIM_SNAPSHOT_PAGE_SIZE in the file and mapped copy-on-write on restore, so
+// that many simulations can start from the same snapshot at little cost.
+
+#ifndef SIM_SNAPSHOT_H
+#define SIM_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "Vtop.h"
+
+// Multiple of the host page size on all supported hosts
+#define SIM_SNAPSHOT_PAGE_SIZE (64 * 1024)
+
+bool sim_snapshot_save(const char *path, Vtop *top,
+                       const void *state, size_t state_size,
+                       const uint16_t *mem, size_t mem_size);
+
+// Fails without restoring anything if the stored simulator state is shorter
+// than <min_state_size>
+bool sim_snapshot_restore(const char *path, Vtop *top,
+                          std::vector<uint8_t> *state, size_t min_state_size,
+                          uint16_t *mem, size_t mem_size);
+
+#endif  // SIM_SNAPSHOT_H
@@ -0,0 +1,136 @@
+// sim_trace.cpp
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+#include "sim_trace.h"
+#include "sim_rtl.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+bool sim_trace_open(sim_trace_t *t, const char *path, uint64_t start, uint64_t stop,
+                    uint64_t window, uint64_t ring, int64_t pc, int64_t mmio)
+{
+    *t = sim_trace_t();
+    t->segment = -1;
+    t->done = !path;
+    if (!path)
+        return true;
+
+    t->path = path;
+    t->start = start;
+    t->stop = stop;
+    t->window = window;
+    t->ring = ring;
+    t->pc = pc;
+    t->mmio = mmio;
+    return true;
+}
+
+static std::string stem(const sim_trace_t *t)
+{
+    size_t n = t->path.size();
+    if (n > 4 && t->path.compare(n - 4, 4, ".fst") == 0)
+        return t->path.substr(0, n - 4);
+    return t->path;
+}
+
+static std::string segment_path(const sim_trace_t *t, int segment)
+{
+    return stem(t) + ".ring" + std::to_string(segment) + ".fst";
+}
+
+static void open_file(sim_trace_t *t, const std::string &path, Vtop *top)
+{
+    t->tfp = new VerilatedFstC;
+    top->trace(t->tfp, 99);
+    t->tfp->open(path.c_str());
+}
+
+static void close_file(sim_trace_t *t, uint64_t cycles)
+{
+    if (!t->tfp)
+        return;
+    t->tfp->close();
+    delete t->tfp;
+    t->tfp = nullptr;
+    if (t->segment >= 0)
+        t->segment_end[t->segment] = cycles;
+}
+
+static void next_segment(sim_trace_t *t, uint64_t cycles, Vtop *top)
+{
+    close_file(t, cycles);
+    t->segment = t->segment < 0 ? 0 : t->segment ^ 1;
+    t->segment_start[t->segment] = cycles;
+    t->nb_segments++;
+    open_file(t, t->ring ? segment_path(t, t->segment) : t->path, top);
+}
+
+void sim_trace_posedge(sim_trace_t *t, uint64_t cycles, Vtop *top)
+{
+    if (t->done)
+        return;
+
+    bool trigger = t->pc >= 0 || t->mmio >= 0;
+    if ((t->stop && cycles >= t->stop) || (t->triggered && t->window && cycles >= t->trigger_cycle + t->window)) {
+        close_file(t, cycles);
+        t->done = true;
+        return;
+    }
+    if (cycles < t->start)
+        return;
+
+    if (!t->triggered) {
+        bool hit = !trigger;
+        if (t->pc >= 0 && top->cpu_ce_o && (top->cpu_state_o & CPU_STATE_EXECUTE) && top->cpu_pc_o == (uint32_t)t->pc)
+            hit = true;
+        if (t->mmio >= 0 && top->trace_store_o && (top->cpu_addr_o & ~3u) == ((uint32_t)t->mmio & ~3u))
+            hit = true;
+        if (hit) {
+            t->triggered = true;
+            t->trigger_cycle = cycles;
+            if (trigger)
+                printf("Trace triggered at cycle %" PRIu64 "\n", cycles);
+        }
+    }
+
+    if (!t->ring) {
+        if (t->triggered && !t->tfp)
+            next_segment(t, cycles, top);
+        return;
+    }
+
+    // Ring mode: dumped from the start cycle, in turn to the two files until
+    // the trigger
+    if (!t->tfp || ((!trigger || !t->triggered) && cycles - t->segment_start[t->segment] >= t->ring))
+        next_segment(t, cycles, top);
+}
+
+void sim_trace_close(sim_trace_t *t, uint64_t cycles)
+{
+    if (t->path.empty())
+        return;
+    close_file(t, cycles);
+    t->done = true;
+
+    if (t->segment < 0) {
+        printf("Trace: window not reached\n");
+        return;
+    }
+
+    // The current ring file becomes <file>, the other one <file stem>.prev.fst
+    int last = t->segment;
+    int prev = last ^ 1;
+    if (t->ring && rename(segment_path(t, last).c_str(), t->path.c_str()) != 0)
+        perror(t->path.c_str());
+    printf("Trace: %s (cycles %" PRIu64 "-%" PRIu64 ")\n", t->path.c_str(),
+           t->segment_start[last], t->segment_end[last]);
+    if (t->nb_segments > 1) {
+        std::string prev_path = stem(t) + ".prev.fst";
+        if (rename(segment_path(t, prev).c_str(), prev_path.c_str()) != 0)
+            perror(prev_path.c_str());
+        printf("Trace: %s (cycles %" PRIu64 "-%" PRIu64 ")\n", prev_path.c_str(),
+               t->segment_start[prev], t->segment_end[prev]);
+    }
+}
@@ -0,0 +1,62 @@
+// sim_trace.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// Windowed FST trace. Nothing is dumped outside of the window, which opens
+// at a CPU cycle, optionally once the CPU executes a given PC or stores to a
+// given (MMIO) address, and closes after a number of cycles or at another
+// CPU cycle.
+//
+// In ring mode, the trace is written from the start cycle to two files in
+// turn, each holding <ring> cycles, so that at least the last <ring> cycles
+// before the PC/store trigger, or before the end of the run (failed
+// assertion, $finish, cycle budget...), are kept: <file> holds the last
+// ones and <file stem>.prev.fst the ones before.
+
+#ifndef SIM_TRACE_H
+#define SIM_TRACE_H
+
+#include <stdint.h>
+
+#include <string>
+
+#include "Vtop.h"
+#include "verilated_fst_c.h"
+
+struct sim_trace_t {
+    std::string path;
+    uint64_t start;             // CPU cycle opening the window
+    uint64_t stop;              // CPU cycle closing the window, 0 if none
+    uint64_t window;            // CPU cycles after the trigger, 0 for no limit
+    uint64_t ring;              // CPU cycles per ring file, 0 if not in ring mode
+    int64_t pc;                 // trigger PC, -1 if none
+    int64_t mmio;               // trigger store address, -1 if none
+
+    VerilatedFstC *tfp;         // nullptr if not dumping
+    bool triggered;
+    uint64_t trigger_cycle;
+    bool done;
+
+    int segment;                // current ring file (0 or 1), -1 before the first one
+    uint64_t nb_segments;
+    uint64_t segment_start[2];  // CPU cycle
+    uint64_t segment_end[2];
+};
+
+// path may be nullptr for no trace
+bool sim_trace_open(sim_trace_t *t, const char *path, uint64_t start, uint64_t stop,
+                    uint64_t window, uint64_t ring, int64_t pc, int64_t mmio);
+
+// To be called before evaluating each positive edge of clk
+void sim_trace_posedge(sim_trace_t *t, uint64_t cycles, Vtop *top);
+
+// To be called after each evaluation of the model
+static inline void sim_trace_dump(sim_trace_t *t, uint64_t time)
+{
+    if (t->tfp)
+        t->tfp->dump(time);
+}
+
+void sim_trace_close(sim_trace_t *t, uint64_t cycles);
+
+#endif  // SIM_TRACE_H
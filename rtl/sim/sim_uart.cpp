@@ -0,0 +1,197 @@
+// sim_uart.cpp
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+#ifndef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 600   // posix_openpt()
+#endif
+
+#include "sim_uart.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+// Bytes sent to the SoC per poll, the receiver FIFO holds 16 bytes
+#define RX_CHUNK 64
+
+// Terminal settings of stdin, restored on exit whatever the exit path
+static bool restore_termios = false;
+static struct termios saved_termios;
+
+static void restore_stdin(void)
+{
+    if (restore_termios)
+        tcsetattr(STDIN_FILENO, TCSANOW, &saved_termios);
+    restore_termios = false;
+}
+
+bool sim_uart_open(sim_uart_t *u, sim_uart_mode_t mode, int bit_cycles)
+{
+    *u = sim_uart_t();
+    u->mode = mode;
+    u->in_fd = -1;
+    u->out_fd = -1;
+    u->bit_cycles = bit_cycles;
+
+    if (mode == SIM_UART_STDIO) {
+        u->in_fd = STDIN_FILENO;
+        u->out_fd = STDOUT_FILENO;
+        // Pass the keys through as they are typed
+        if (!restore_termios && isatty(u->in_fd) && tcgetattr(u->in_fd, &saved_termios) == 0) {
+            struct termios t = saved_termios;
+            t.c_lflag &= ~(ICANON | ECHO);
+            t.c_cc[VMIN] = 0;
+            t.c_cc[VTIME] = 0;
+            tcsetattr(u->in_fd, TCSANOW, &t);
+            restore_termios = true;
+            atexit(restore_stdin);
+        }
+    } else if (mode == SIM_UART_PTY) {
+        int fd = posix_openpt(O_RDWR | O_NOCTTY);
+        if (fd < 0 || grantpt(fd) < 0 || unlockpt(fd) < 0) {
+            perror("UART pseudo-terminal");
+            if (fd >= 0)
+                close(fd);
+            return false;
+        }
+        struct termios t;
+        if (tcgetattr(fd, &t) == 0) {
+            cfmakeraw(&t);
+            tcsetattr(fd, TCSANOW, &t);
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        u->in_fd = fd;
+        u->out_fd = fd;
+        printf("UART connected to %s\n", ptsname(fd));
+    }
+
+    return true;
+}
+
+void sim_uart_posedge(sim_uart_t *u, Vtop *top)
+{
+#ifdef UART_BACKDOOR
+    if (top->uart_bd_tx_strobe_o)
+        u->tx_buf.push_back((char)top->uart_bd_tx_data_o);
+
+    if (top->uart_bd_rx_done_o && !u->rx_queue.empty())
+        u->rx_queue.pop_front();
+    top->uart_bd_rx_rdy_i = !u->rx_queue.empty();
+    top->uart_bd_rx_data_i = u->rx_queue.empty() ? 0 : u->rx_queue.front();
+#else // UART_BACKDOOR
+    // SoC -> host: sample each bit in its middle
+    if (u->tx_busy) {
+        if (--u->tx_count == 0) {
+            if (u->tx_bit < 8) {
+                u->tx_shift = (uint8_t)((u->tx_shift >> 1) | (top->tx_o ? 0x80 : 0));
+                u->tx_count = u->bit_cycles;
+                if (++u->tx_bit == 8)
+                    u->tx_buf.push_back((char)u->tx_shift);
+            } else {
+                // Middle of the stop bit
+                u->tx_busy = false;
+            }
+        }
+    } else if (!top->tx_o) {
+        // Start bit
+        u->tx_busy = true;
+        u->tx_bit = 0;
+        u->tx_count = u->bit_cycles + u->bit_cycles / 2;
+    }
+
+    // Host -> SoC
+    if (!u->rx_busy && !u->rx_queue.empty()) {
+        u->rx_frame = (uint16_t)(0x200 | (u->rx_queue.front() << 1));
+        u->rx_queue.pop_front();
+        u->rx_busy = true;
+        u->rx_bit = 0;
+        u->rx_count = u->bit_cycles;
+    }
+    if (u->rx_busy) {
+        top->rx_i = (u->rx_frame >> u->rx_bit) & 1;
+        if (--u->rx_count == 0) {
+            u->rx_count = u->bit_cycles;
+            if (++u->rx_bit == 10)
+                u->rx_busy = false;
+        }
+    } else {
+        top->rx_i = 1;
+    }
+#endif // UART_BACKDOOR
+}
+
+void sim_uart_poll(sim_uart_t *u)
+{
+    if (u->mode == SIM_UART_NONE) {
+        u->tx_buf.clear();
+        return;
+    }
+
+    if (!u->tx_buf.empty()) {
+        ssize_t n = write(u->out_fd, u->tx_buf.data(), u->tx_buf.size());
+        if (n > 0)
+            u->tx_buf.erase(0, (size_t)n);
+        else if (u->mode == SIM_UART_PTY)
+            u->tx_buf.clear();  // nobody connected
+    }
+
+    // Only read more once the SoC has received the previous chunk
+    if (u->rx_queue.size() >= RX_CHUNK)
+        return;
+
+    struct pollfd pfd = {u->in_fd, POLLIN, 0};
+    if (poll(&pfd, 1, 0) > 0 && (pfd.revents & POLLIN)) {
+        uint8_t buf[RX_CHUNK];
+        ssize_t n = read(u->in_fd, buf, sizeof(buf));
+        for (ssize_t i = 0; i < n; ++i)
+            u->rx_queue.push_back(buf[i]);
+    }
+}
+
+void sim_uart_save(const sim_uart_t *u, sim_uart_state_t *state, std::vector<uint8_t> *queue)
+{
+    state->tx_busy = u->tx_busy;
+    state->tx_count = u->tx_count;
+    state->tx_bit = u->tx_bit;
+    state->tx_shift = u->tx_shift;
+    state->rx_busy = u->rx_busy;
+    state->rx_count = u->rx_count;
+    state->rx_bit = u->rx_bit;
+    state->rx_frame = u->rx_frame;
+    state->rx_len = (uint32_t)u->rx_queue.size();
+    queue->insert(queue->end(), u->rx_queue.begin(), u->rx_queue.end());
+}
+
+bool sim_uart_restore(sim_uart_t *u, const sim_uart_state_t *state, const uint8_t *queue, size_t queue_size)
+{
+    if (queue_size != state->rx_len)
+        return false;
+
+    u->tx_busy = state->tx_busy;
+    u->tx_count = state->tx_count;
+    u->tx_bit = state->tx_bit;
+    u->tx_shift = state->tx_shift;
+    u->rx_busy = state->rx_busy;
+    u->rx_count = state->rx_count;
+    u->rx_bit = state->rx_bit;
+    u->rx_frame = state->rx_frame;
+    u->rx_queue.assign(queue, queue + queue_size);
+
+    return true;
+}
+
+void sim_uart_close(sim_uart_t *u)
+{
+    sim_uart_poll(u);
+
+    if (u->mode == SIM_UART_STDIO)
+        restore_stdin();
+    if (u->mode == SIM_UART_PTY && u->in_fd >= 0)
+        close(u->in_fd);
+    u->mode = SIM_UART_NONE;
+}
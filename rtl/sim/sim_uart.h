@@ -0,0 +1,82 @@
+// sim_uart.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// Host side of the UART, connected to stdin/stdout or to a pseudo-terminal.
+// The bytes are exchanged either serially on the rx_i/tx_o pins at the baud
+// rate of the SoC, or directly through the byte-level interface of a model
+// built with UART_BACKDOOR.
+
+#ifndef SIM_UART_H
+#define SIM_UART_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "Vtop.h"
+
+enum sim_uart_mode_t {
+    SIM_UART_NONE,
+    SIM_UART_STDIO,
+    SIM_UART_PTY
+};
+
+struct sim_uart_t {
+    sim_uart_mode_t mode;
+    int in_fd;
+    int out_fd;
+
+    int bit_cycles;             // CPU cycles per bit
+
+    // Serial receiver (tx_o)
+    bool tx_busy;
+    int tx_count;               // cycles before the next sample
+    int tx_bit;
+    uint8_t tx_shift;
+
+    // Serial transmitter (rx_i)
+    bool rx_busy;
+    int rx_count;               // cycles left in the current bit
+    int rx_bit;
+    uint16_t rx_frame;          // start bit, 8 data bits, stop bit
+
+    std::deque<uint8_t> rx_queue;   // host -> SoC
+    std::string tx_buf;             // SoC -> host, flushed by sim_uart_poll()
+};
+
+// Serial state, saved in a snapshot; the rx_len pending host bytes follow
+struct sim_uart_state_t {
+    bool tx_busy;
+    int tx_count;
+    int tx_bit;
+    uint8_t tx_shift;
+    bool rx_busy;
+    int rx_count;
+    int rx_bit;
+    uint16_t rx_frame;
+    uint32_t rx_len;
+};
+
+// Returns false if the host side cannot be opened
+bool sim_uart_open(sim_uart_t *u, sim_uart_mode_t mode, int bit_cycles);
+
+// To be called before evaluating each positive edge of clk
+void sim_uart_posedge(sim_uart_t *u, Vtop *top);
+
+// Host I/O, to be called periodically
+void sim_uart_poll(sim_uart_t *u);
+
+// Appends the pending host bytes to <queue>
+void sim_uart_save(const sim_uart_t *u, sim_uart_state_t *state, std::vector<uint8_t> *queue);
+
+// The SoC output not yet written to the host is kept. Returns false if
+// <queue_size> does not match the saved number of pending bytes
+bool sim_uart_restore(sim_uart_t *u, const sim_uart_state_t *state, const uint8_t *queue, size_t queue_size);
+
+void sim_uart_close(sim_uart_t *u);
+
+#endif  // SIM_UART_H
@@ -0,0 +1,60 @@
+// sim_video.cpp
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+#include "sim_video.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+void sim_video_open(sim_video_t *v, bool throttled, uint64_t period)
+{
+    *v = sim_video_t();
+    v->throttled = throttled;
+    v->period = period;
+    v->on = true;               // first frame at cycle 0
+}
+
+void sim_video_request(sim_video_t *v)
+{
+    v->request = v->throttled;
+}
+
+bool sim_video_posedge(sim_video_t *v, uint64_t cycles, Vtop *top)
+{
+    // vga_vsync is active low, a frame ends at the start of the vsync pulse
+    bool vsync = !top->vga_vsync;
+    if (v->on && vsync && !v->vsync) {
+        v->frames++;
+        if (v->throttled)
+            v->on = false;
+    }
+    v->vsync = vsync;
+
+    if (!v->on && (v->request || (v->period && cycles >= v->next_frame))) {
+        v->on = true;
+        v->request = false;
+        if (v->period)
+            v->next_frame = cycles + v->period;
+    }
+
+    return v->on;
+}
+
+void sim_video_sdram_posedge(sim_video_t *v, Vtop *top)
+{
+    v->sdram_cycles++;
+    if (top->video_refill) {
+        if (!v->refill)
+            v->refills++;
+        v->refill_cycles++;
+    }
+    v->refill = top->video_refill;
+}
+
+void sim_video_close(sim_video_t *v)
+{
+    printf("Video: %" PRIu64 " frames, %" PRIu64 " refills (%" PRIu64 " bytes), %.1f%% of the SDRAM cycles\n",
+           v->frames, v->refills, v->refills * 32,
+           v->sdram_cycles ? 100.0 * v->refill_cycles / v->sdram_cycles : 0.0);
+}
@@ -0,0 +1,49 @@
+// sim_video.h
+// Copyright (c) 2026 Daniel Cliche
+// SPDX-License-Identifier: MIT
+
+// Video scan-out throttling. When throttled, the pixel clock runs with the CPU
+// clock for one frame every <period> CPU cycles and/or on demand, and is
+// stopped in between:
+// the video pipeline is then not evaluated and, once its queue is full, no
+// longer refills it from the SDRAM. The SDRAM cycles taken by the video
+// refills are reported.
+
+#ifndef SIM_VIDEO_H
+#define SIM_VIDEO_H
+
+#include <stdint.h>
+
+#include "Vtop.h"
+
+struct sim_video_t {
+    bool throttled;
+    uint64_t period;            // CPU cycles per frame, 0: on demand only
+    uint64_t next_frame;        // cycle of the next frame
+    bool on;                    // pixel clock running
+    bool request;               // frame requested
+    bool vsync;
+
+    uint64_t frames;            // frames scanned out
+    uint64_t sdram_cycles;
+    uint64_t refill_cycles;     // clk_sdram cycles serving a video refill
+    uint64_t refills;
+    bool refill;
+};
+
+void sim_video_open(sim_video_t *v, bool throttled, uint64_t period);
+
+// Scans out one more frame as soon as possible, if throttled
+void sim_video_request(sim_video_t *v);
+
+// To be called before evaluating each positive edge of clk. Returns whether
+// clk_pixel follows clk until the next positive edge.
+bool sim_video_posedge(sim_video_t *v, uint64_t cycles, Vtop *top);
+
+// To be called before evaluating each positive edge of clk_sdram
+void sim_video_sdram_posedge(sim_video_t *v, Vtop *top);
+
+// Prints the summary
+void sim_video_close(sim_video_t *v);
+
+#endif  // SIM_VIDEO_H
@@ -2,23 +2,53 @@
 // Copyright (c) 2023-2024 Daniel Cliche
 // SPDX-License-Identifier: MIT
 
-module top (
+module top #(
+    parameter FREQ_HZ = 25_000_000,
+    parameter CPU_PREFETCH = 0,
+    parameter CPU_BRANCH_PREDICT = 0,
+    parameter CPU_DIV_BITS = 1
+) (
     input  wire logic        clk,
     input  wire logic        clk_sdram,
+    input  wire logic        clk_pixel,     // clk, or stopped between frames
     input  wire logic        reset_i,
     output      logic [7:0]  display_o,
     input  wire logic        rx_i,
     output      logic        tx_o,
 
+    // SD card
+    input  wire logic        sd_do_i,
+    output      logic        sd_di_o,
+    output      logic        sd_ck_o,
+    output      logic        sd_cs_n_o,
+
     output      logic        vga_hsync,
     output      logic        vga_vsync,
+    output      logic        vga_blank,
     output      logic [7:0]  vga_r,
     output      logic [7:0]  vga_g,
     output      logic [7:0]  vga_b,
+    output      logic        video_refill,  // SDRAM serving a video queue refill
+
+    // CPU store to the memory, performed on the next clk edge
+    output      logic        cpu_store_o,
+    output      logic [31:0] cpu_addr_o,
+    output      logic [31:0] cpu_wdata_o,
+    output      logic [3:0]  cpu_wmask_o,
+
+    // Processor reset and state, sampled by the simulator (instruction-set
+    // model handoff, performance counters, profiler, trace triggers, GDB stub)
+    output      logic        cpu_reset_o,
+    output      logic [5:0]  cpu_state_o,
+    output      logic        cpu_ce_o,
+    output      logic [31:0] cpu_pc_o,
 
+    // PS/2 keyboard codes and mouse words
     input  wire logic [7:0]  ps2_kbd_code_i,
     input  wire logic        ps2_kbd_strobe_i,
     input  wire logic        ps2_kbd_err_i,
+    input  wire logic [26:0] ps2_mouse_data_i,
+    input  wire logic        ps2_mouse_strobe_i,
 
     // SDRAM
     output      logic        sdram_clk_o,
@@ -31,34 +61,95 @@ module top (
     output      logic [1:0]  sdram_ba_o,
     output      logic [1:0]  sdram_dqm_o,
     inout       logic [15:0] sdram_dq_io  
+`ifdef SDRAM_TLM
+    ,
+    output      logic [1:0]  sdram_tlm_cmd_o,
+    output      logic [22:0] sdram_tlm_addr_o,
+    output      logic [15:0] sdram_tlm_din_o,
+    input  wire logic [15:0] sdram_tlm_dout_i,
+    input  wire logic        sdram_tlm_rd_data_valid_i,
+    input  wire logic        sdram_tlm_wr_data_valid_i,
+    input  wire logic [1:0]  sdram_tlm_cmd_ack_i
+`endif // SDRAM_TLM
+`ifdef UART_BACKDOOR
+    ,
+    output      logic        uart_bd_tx_strobe_o,
+    output      logic [7:0]  uart_bd_tx_data_o,
+    input  wire logic [7:0]  uart_bd_rx_data_i,
+    input  wire logic        uart_bd_rx_rdy_i,
+    output      logic        uart_bd_rx_done_o
+`endif // UART_BACKDOOR
+`ifdef PERF
+    ,
+    // Internal signals sampled by the simulator performance counters
+    output      logic        perf_cache_mreq_o,
+    output      logic        perf_cache_req_o,
+    output      logic        perf_cache_hit_o,
+    output      logic [2:0]  perf_cache_state_o,
+    output      logic        perf_cache_flush_o,
+    output      logic [1:0]  perf_sdram_cmd_ack_o,
+    output      logic        perf_video_almost_empty_o,
+    output      logic        perf_video_underrun_o,
+    output      logic        perf_graphite_busy_o,
+    output      logic        perf_graphite_mem_o
+`endif // PERF
+`ifdef PROF
+    ,
+    // Instruction sampled by the simulator profiler
+    output      logic [31:0] prof_instr_o
+`endif // PROF
+`ifdef TRACE
+    ,
+    // Store sampled by the simulator trace triggers
+    output      logic        trace_store_o
+`endif // TRACE
+`ifdef CACHE_TRACE
+    ,
+    // Cache controller requests recorded by the simulator
+    output      logic        cache_trace_req_o,
+    output      logic [25:0] cache_trace_addr_o,
+    output      logic [3:0]  cache_trace_wmask_o,
+    output      logic        cache_trace_graphite_o,
+    output      logic        cache_trace_flush_o
+`endif // CACHE_TRACE
     );
 
     assign sdram_cke_o = 1'b1; // SDRAM clock enable
 
-    soc_top soc_top
+    soc_top #(
+        .FREQ_HZ(FREQ_HZ),
+        .CPU_PREFETCH(CPU_PREFETCH),
+        .CPU_BRANCH_PREDICT(CPU_BRANCH_PREDICT),
+        .CPU_DIV_BITS(CPU_DIV_BITS)
+    ) soc_top
     (
         .clk_cpu(clk),
         .clk_sdram(clk_sdram),
-        .clk_pixel(clk),
+        .clk_pixel(clk_pixel),
         .reset_i(reset_i),
 
         // UART
-        .rx_i(),
-        .tx_o(),
+        .rx_i(rx_i),
+        .tx_o(tx_o),
         // LED
         .led_o(display_o),
         // SD card
-        .sd_do_i(),
-        .sd_di_o(),
-        .sd_ck_o(),
-        .sd_cs_n_o(),
+        .sd_do_i(sd_do_i),
+        .sd_di_o(sd_di_o),
+        .sd_ck_o(sd_ck_o),
+        .sd_cs_n_o(sd_cs_n_o),
         // VGA video
         .vga_hsync_o(vga_hsync),
         .vga_vsync_o(vga_vsync),
-        .vga_blank_o(),
+        .vga_blank_o(vga_blank),
         .vga_r_o(vga_r),
         .vga_g_o(vga_g),
         .vga_b_o(vga_b),
+        // PS/2 keyboard and mouse
+        .ps2_kbd_code_i(ps2_kbd_code_i),
+        .ps2_kbd_strobe_i(ps2_kbd_strobe_i),
+        .ps2_mouse_data_i(ps2_mouse_data_i),
+        .ps2_mouse_strobe_i(ps2_mouse_strobe_i),
         // SDRAM
         .sdram_cas_n_o(sdram_cas_n_o),
         .sdram_ras_n_o(sdram_ras_n_o),
@@ -68,12 +159,73 @@ module top (
         .sdram_addr_o(sdram_a_o),
         .sdram_data_io(sdram_dq_io),
         .sdram_dqm_o(sdram_dqm_o)
+`ifdef SDRAM_TLM
+        ,
+        .sdram_tlm_cmd_o(sdram_tlm_cmd_o),
+        .sdram_tlm_addr_o(sdram_tlm_addr_o),
+        .sdram_tlm_din_o(sdram_tlm_din_o),
+        .sdram_tlm_dout_i(sdram_tlm_dout_i),
+        .sdram_tlm_rd_data_valid_i(sdram_tlm_rd_data_valid_i),
+        .sdram_tlm_wr_data_valid_i(sdram_tlm_wr_data_valid_i),
+        .sdram_tlm_cmd_ack_i(sdram_tlm_cmd_ack_i)
+`endif // SDRAM_TLM
+`ifdef UART_BACKDOOR
+        ,
+        .uart_bd_tx_strobe_o(uart_bd_tx_strobe_o),
+        .uart_bd_tx_data_o(uart_bd_tx_data_o),
+        .uart_bd_rx_data_i(uart_bd_rx_data_i),
+        .uart_bd_rx_rdy_i(uart_bd_rx_rdy_i),
+        .uart_bd_rx_done_o(uart_bd_rx_done_o)
+`endif // UART_BACKDOOR
     );
 
-    initial begin
-        //$display("[%0t] Tracing to logs/vlt_dump.vcd...\n", $time);
-        //$dumpfile("logs/vlt_dump.vcd");
-        //$dumpvars();
-    end
-    
+    assign video_refill = soc_top.sys_cmd_ack == 2'b10;
+
+    assign cpu_store_o = soc_top.processor.ce && !soc_top.ioenb && !soc_top.pm_sel && !soc_top.vdu_sel && |soc_top.wmask;
+    assign cpu_addr_o  = soc_top.adr;
+    assign cpu_wdata_o = soc_top.outbus;
+    assign cpu_wmask_o = soc_top.wmask;
+    assign cpu_reset_o = !soc_top.rst_n;
+    assign cpu_state_o = soc_top.processor.state;
+    assign cpu_ce_o    = soc_top.processor.ce;
+    assign cpu_pc_o    = soc_top.processor.PC;
+
+`ifdef PERF
+    assign perf_cache_mreq_o         = soc_top.cache_ctrl.mreq;
+    assign perf_cache_req_o          = soc_top.cache_ctrl_req;
+    assign perf_cache_hit_o          = soc_top.cache_ctrl.hit;
+    assign perf_cache_state_o        = soc_top.cache_ctrl.STATE;
+    assign perf_cache_flush_o        = soc_top.cache_ctrl.r_flush;
+    assign perf_sdram_cmd_ack_o      = soc_top.sys_cmd_ack;
+    assign perf_video_almost_empty_o = soc_top.almost_empty;
+    assign perf_video_underrun_o     = soc_top.dspreq && soc_top.empty;
+`ifdef VIDEO_GRAPHITE
+    assign perf_graphite_busy_o      = !soc_top.graphite_cmd_axis_tready;
+    assign perf_graphite_mem_o       = soc_top.process_graphite;
+`else // VIDEO_GRAPHITE
+    assign perf_graphite_busy_o      = 1'b0;
+    assign perf_graphite_mem_o       = 1'b0;
+`endif // VIDEO_GRAPHITE
+`endif // PERF
+
+`ifdef PROF
+    assign prof_instr_o = {soc_top.processor.instr, 2'b11};   // decompressed
+`endif // PROF
+
+`ifdef TRACE
+    assign trace_store_o = soc_top.processor.ce && |soc_top.wmask;
+`endif // TRACE
+
+`ifdef CACHE_TRACE
+    assign cache_trace_req_o      = soc_top.cache_ctrl.STATE == 3'b000 && soc_top.cache_ctrl_mreq && soc_top.cache_ctrl.hit;
+    assign cache_trace_addr_o     = soc_top.cache_ctrl_adr[25:0];
+    assign cache_trace_wmask_o    = soc_top.cache_ctrl_wmask;
+`ifdef VIDEO_GRAPHITE
+    assign cache_trace_graphite_o = soc_top.process_graphite;
+`else // VIDEO_GRAPHITE
+    assign cache_trace_graphite_o = 1'b0;
+`endif // VIDEO_GRAPHITE
+    assign cache_trace_flush_o    = soc_top.cache_ctrl.r_flush;
+`endif // CACHE_TRACE
+
 endmodule
\ No newline at end of file
@@ -31,7 +31,10 @@ CONNECTION WITH THE DEALINGS IN OR USE OR PERFORMANCE OF THE SOFTWARE.
 module soc_top #(
     parameter FREQ_HZ = 25_000_000,
     parameter BAUD_RATE = 115_200,
-    parameter DEFAULT_FB_ADDRESS = 32'h1000000
+    parameter DEFAULT_FB_ADDRESS = 32'h1000000,
+    parameter CPU_PREFETCH = 0,             // see processor.v
+    parameter CPU_BRANCH_PREDICT = 0,
+    parameter CPU_DIV_BITS = 1
 ) (
     input  wire logic        clk_cpu,
     input  wire logic        clk_sdram,
@@ -59,14 +62,26 @@ module soc_top #(
     output      logic [7:0]  vga_b_o,
 `endif
 `ifdef PS2_KBD
+`ifdef PS2_SIM
+    // PS/2 keyboard codes from the simulator
+    input  wire logic [7:0]  ps2_kbd_code_i,
+    input  wire logic        ps2_kbd_strobe_i,
+`else // PS2_SIM
     // PS/2 keyboard
     input  wire logic        ps2clka_i,
     input  wire logic        ps2data_i,
+`endif // PS2_SIM
 `endif // PS2_KBD
 `ifdef PS2_MOUSE
+`ifdef PS2_SIM
+    // PS/2 mouse words (buttons, dx, dy, dz) from the simulator
+    input  wire logic [26:0] ps2_mouse_data_i,
+    input  wire logic        ps2_mouse_strobe_i,
+`else // PS2_SIM
     // PS/2 mouse
     inout       logic        ps2clkb_io,
     inout       logic        ps2datb_io,
+`endif // PS2_SIM
 `endif // PS/2 mouse
 `ifdef USB
     // USB
@@ -85,6 +100,26 @@ module soc_top #(
     output      logic [12:0] sdram_addr_o,
     inout       logic [15:0] sdram_data_io,
     output wire logic [1:0]  sdram_dqm_o
+`ifdef SDRAM_TLM
+    ,
+    // SDRAM transaction-level interface (simulation only, replaces the SDRAM controller)
+    output      logic [1:0]  sdram_tlm_cmd_o,
+    output      logic [22:0] sdram_tlm_addr_o,
+    output      logic [15:0] sdram_tlm_din_o,
+    input  wire logic [15:0] sdram_tlm_dout_i,
+    input  wire logic        sdram_tlm_rd_data_valid_i,
+    input  wire logic        sdram_tlm_wr_data_valid_i,
+    input  wire logic [1:0]  sdram_tlm_cmd_ack_i
+`endif // SDRAM_TLM
+`ifdef UART_BACKDOOR
+    ,
+    // UART byte-level interface (simulation only, replaces the UART)
+    output      logic        uart_bd_tx_strobe_o,
+    output      logic [7:0]  uart_bd_tx_data_o,
+    input  wire logic [7:0]  uart_bd_rx_data_i,
+    input  wire logic        uart_bd_rx_rdy_i,
+    output      logic        uart_bd_rx_done_o
+`endif // UART_BACKDOOR
 );
 
     // IO addresses for read / write
@@ -190,6 +225,7 @@ module soc_top #(
     logic [1:0]  SCLK, MOSI;
     logic [1:0]  SS;
     logic CE; 
+    logic cache_miss;
     logic empty;
     logic qready = 1'b0;
     logic req_flush_cache;
@@ -222,8 +258,8 @@ module soc_top #(
 `endif // PS2_MOUSE
     logic limit;  // of cnt0
 
-    logic [16:0] cnt0 = 0;
-    logic [31:0] cnt1 = 0; // milliseconds
+    logic [16:0] cnt0 /* verilator public_flat_rw */ = 0;
+    logic [31:0] cnt1 /* verilator public_flat_rw */ = 0; // milliseconds
 
     logic [31:0] spiRx;
     logic spiStart, spiRdy;
@@ -250,7 +286,11 @@ module soc_top #(
     logic cpu_rstrb;
     assign cpu_we = |wmask;
     assign cpu_sel = cpu_we | cpu_rstrb;
-    processor processor(
+    processor #(
+        .PREFETCH(CPU_PREFETCH),
+        .BRANCH_PREDICT(CPU_BRANCH_PREDICT),
+        .DIV_BITS(CPU_DIV_BITS)
+    ) processor(
         .clk(clk_cpu),
 `ifdef VIDEO_GRAPHITE
         .ce(CE && !process_graphite),
@@ -267,13 +307,31 @@ module soc_top #(
 
         .interrupt_request(1'b0),
 
+        .perf_cache_miss(cache_miss),
+`ifdef VIDEO_GRAPHITE
+        .perf_graphite_busy(!graphite_cmd_axis_tready),
+`else // VIDEO_GRAPHITE
+        .perf_graphite_busy(1'b0),
+`endif // VIDEO_GRAPHITE
+
         .reset(rst_n)
     );
 
+`ifdef UART_BACKDOOR
+    // The simulator exchanges the bytes directly, the transmitter is always ready
+    assign uart_bd_tx_strobe_o = startTx & CE;
+    assign uart_bd_tx_data_o   = dataTx;
+    assign uart_bd_rx_done_o   = doneRx;
+    assign dataRx = uart_bd_rx_data_i;
+    assign rdyRx  = uart_bd_rx_rdy_i;
+    assign rdyTx  = 1'b1;
+    assign tx_o   = 1'b1;
+`else // UART_BACKDOOR
     uart_rx #(.FREQ_HZ(FREQ_HZ), .BAUD_RATE(BAUD_RATE)) uart_rx(.clk(clk_cpu), .rst(rst_n), .RxD(rx_i), .fsel(1'b0), .done(doneRx),
     .data(dataRx), .rdy(rdyRx));
     uart_tx #(.FREQ_HZ(FREQ_HZ), .BAUD_RATE(BAUD_RATE)) uart_tx(.clk(clk_cpu), .rst(rst_n), .start(startTx), .fsel(1'b0),
     .data(dataTx), .TxD(tx_o), .rdy(rdyTx));
+`endif // UART_BACKDOOR
     spi #(.FREQ_HZ(FREQ_HZ)) spi(.clk(clk_cpu), .rst(rst_n), .start(spiStart), .dataTx(outbus),
     .fast(spiCtrl[2]), .dataRx(spiRx), .rdy(spiRdy),
         .SCLK(SCLK[0]), .MOSI(MOSI[0]), .MISO(MISO[0] & MISO[1]));
@@ -321,11 +379,20 @@ module soc_top #(
 `endif // VIDEO
 
 `ifdef PS2_KBD
+`ifdef PS2_SIM
+    ps2_sim_fifo #(.data_width(8)) ps2kbd(.clk(clk_cpu), .rst(rst_n), .data_i(ps2_kbd_code_i),
+    .strobe_i(ps2_kbd_strobe_i), .done(doneKbd), .rdy(rdyKbd), .data(dataKbd));
+`else // PS2_SIM
     ps2kbd ps2kbd(.clk(clk_cpu), .rst(rst_n), .done(doneKbd), .rdy(rdyKbd), .shift(),
     .data(dataKbd), .PS2C(ps2clka_i), .PS2D(ps2data_i));
+`endif // PS2_SIM
 `endif // PS2_KBD
 
 `ifdef PS2_MOUSE
+`ifdef PS2_SIM
+    ps2_sim_fifo #(.data_width(27)) ps2mouse(.clk(clk_cpu), .rst(rst_n), .data_i(ps2_mouse_data_i),
+    .strobe_i(ps2_mouse_strobe_i), .done(doneMs), .rdy(rdyMs), .data(dataMs));
+`else // PS2_SIM
     ps2mouse
     #(.c_z_ena(1))
     ps2mouse
@@ -333,6 +400,7 @@ module soc_top #(
     .clk(clk_cpu), .ps2m_reset(~rst_n), .ps2m_clk(ps2clkb_io), .ps2m_dat(ps2datb_io),
     .done(doneMs), .rdy(rdyMs), .data(dataMs)   
     );
+`endif // PS2_SIM
 `endif // PS2_MOUSE
 
 `ifdef USB
@@ -403,7 +471,7 @@ module soc_top #(
 `endif // USB
 
 `ifdef VIDEO_FB
-    logic [31:0]    fb_addr;     
+    logic [31:0]    fb_addr /* verilator public_flat_rw */;
 
 `ifdef VIDEO_GRAPHITE
     // Graphite
@@ -650,6 +718,21 @@ module soc_top #(
         endcase
     end
 
+`ifdef SDRAM_TLM
+    // The simulator serves the bursts directly from its memory array
+    assign sdram_tlm_cmd_o   = cntrl0_user_command_register;
+    assign sdram_tlm_addr_o  = sys_addr;
+    assign sdram_tlm_din_o   = cntrl0_user_input_data;
+    assign sys_DOUT          = sdram_tlm_dout_i;
+    assign sys_rd_data_valid = sdram_tlm_rd_data_valid_i;
+    assign sys_wr_data_valid = sdram_tlm_wr_data_valid_i;
+    assign sys_cmd_ack       = sdram_tlm_cmd_ack_i;
+
+    assign {sdram_cs_n_o, sdram_we_n_o, sdram_ras_n_o, sdram_cas_n_o} = 4'b1111;
+    assign sdram_ba_o   = 2'b00;
+    assign sdram_addr_o = 13'd0;
+    assign sdram_dqm_o  = 2'b11;
+`else // SDRAM_TLM
     sdram sdram
     (
         .sys_CLK(clk_sdram),				// clock
@@ -667,6 +750,7 @@ module soc_top #(
         .sdr_DATA(sdram_data_io),				// SDRAM data
         .sdr_DQM(sdram_dqm_o)					// SDRAM DQM
     );
+`endif // SDRAM_TLM
     
     logic ddr_rd;
     logic ddr_wr;
@@ -675,6 +759,7 @@ module soc_top #(
     logic [31:0] cache_ctrl_din;
     logic cache_ctrl_mreq;
     logic [3:0] cache_ctrl_wmask;
+    logic cache_ctrl_req;   // request issued (mreq only decodes the address), for the simulator
 
 `ifdef VIDEO_GRAPHITE
     logic process_graphite;
@@ -688,6 +773,7 @@ module soc_top #(
             cache_ctrl_din = {graphite_vram_data_out, graphite_vram_data_out};
             //cache_ctrl_din = {16'd0, graphite_vram_data_out};
             cache_ctrl_mreq = graphite_vram_sel;
+            cache_ctrl_req = graphite_vram_sel;
             cache_ctrl_wmask = graphite_vram_addr[0] ? {{2{graphite_vram_wr}}, 2'b0} : {2'b0, {2{graphite_vram_wr}}};
             //cache_ctrl_wmask = {4{graphite_vram_wr}};
         end else
@@ -696,6 +782,7 @@ module soc_top #(
             cache_ctrl_adr = adr;
             cache_ctrl_din = outbus;
             cache_ctrl_mreq = mreq;
+            cache_ctrl_req = mreq && cpu_sel;
             cache_ctrl_wmask = wmask & {4{wr}};
         end
     end
@@ -709,6 +796,7 @@ module soc_top #(
          .mreq(cache_ctrl_mreq), 
          .wmask(cache_ctrl_wmask),
          .ce(CE), 
+         .miss(cache_miss),
          .ddr_din(sys_DOUT), 
          .ddr_dout(cntrl0_user_input_data), 
          .ddr_clk(clk_sdram), 
@@ -161,5 +161,21 @@ portable_init(core_portable *p, int *argc, char *argv[])
 void
 portable_fini(core_portable *p)
 {
+    /* Score per MHz of the CPU clock, comparable across clock frequencies.
+       p is the port member of the results of the first context. */
+    core_results *r = (core_results *)((char *)p - offsetof(core_results, port));
+    CORE_TICKS    ticks = get_time();
+    if (time_in_secs(ticks) > 0)
+    {
+#if HAS_FLOAT
+        ee_printf("CoreMark/MHz     : %f\n",
+                  default_num_contexts * r->iterations / time_in_secs(ticks)
+                      / (CPU_FREQ_HZ / 1000000));
+#else
+        ee_printf("CoreMark/MHz     : %d\n",
+                  default_num_contexts * r->iterations / time_in_secs(ticks)
+                      / (CPU_FREQ_HZ / 1000000));
+#endif
+    }
     p->portable_id = 0;
 }
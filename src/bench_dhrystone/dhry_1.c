@@ -16,6 +16,7 @@
  */
 
 #include "dhry.h"
+#include "io.h"
 
 #ifndef DHRY_ITERS
 #define DHRY_ITERS 200000
@@ -292,6 +293,15 @@ main ()
     printf ("Dhrystones per Second:                      ");
     //printf ("%6.1f \n", Dhrystones_Per_Second);
     printf ("%d \n", (int)Dhrystones_Per_Second);
+    /* DMIPS: relative to the 1757 Dhrystones per second of the VAX 11/780 */
+    {
+      int DMIPS_Per_MHz = (int) (Dhrystones_Per_Second * 1000.0f
+                        / (1757.0f * (CPU_FREQ_HZ / 1000000)));
+      printf ("DMIPS:                                      ");
+      printf ("%d \n", (int) (Dhrystones_Per_Second / 1757.0f));
+      printf ("DMIPS/MHz:                                  ");
+      printf ("%d.%03d \n", DMIPS_Per_MHz / 1000, DMIPS_Per_MHz % 1000);
+    }
     printf ("\n");
   }
   
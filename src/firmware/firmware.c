@@ -81,8 +81,11 @@ void main(void)
     if (hw_conf & 0x1)
         clear(0x8410);  // Gray
 
-    // If running under the simulator, the program has already been loaded
-    if (hw_conf & 0x80000000) {
+    // If running under the simulator, the program has usually been loaded
+    // already (the volatile pointer keeps the compiler from trapping on a
+    // read at address 0)
+    volatile unsigned int * volatile ram = (volatile unsigned int *)RAM_START;
+    if ((hw_conf & 0x80000000) && *ram) {
         void (*program)(void) = (void (*)(void))RAM_START;
         program();
         for(;;);
@@ -21,6 +21,12 @@
 #define PS2_MOUSE_STATUS (BASE_IO + 52)
 #define CONFIG4          (BASE_IO + 56)
 
+// CPU clock (FREQ_HZ of soc_top), TIMER counts its milliseconds. Override
+// with -DCPU_FREQ_HZ for a board or simulator built with another frequency.
+#ifndef CPU_FREQ_HZ
+#define CPU_FREQ_HZ      25000000
+#endif
+
 #define MEM_WRITE(_addr_, _value_) (*((volatile unsigned int *)(_addr_)) = _value_)
 #define MEM_READ(_addr_) *((volatile unsigned int *)(_addr_))
 
@@ -0,0 +1,65 @@
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdint.h>
+
+// Performance counters of the processor (rtl/riscv/processor.v). They are
+// read-only: measure a section of code by taking the difference of two
+// snapshots.
+//
+// PERF_CYCLES counts the cycles the processor is enabled, PERF_STALL the
+// cycles it is held by the cache or Graphite, so their sum is the elapsed
+// time in CPU clocks.
+
+#define PERF_CYCLES         0   // cycle
+#define PERF_INSTRET        2   // instret: retired instructions
+#define PERF_CACHE_MISS     3   // hpmcounter3: cache line fills
+#define PERF_STALL          4   // hpmcounter4: cycles stalled on the clock enable
+#define PERF_FPU_BUSY       5   // hpmcounter5: FPU busy cycles
+#define PERF_DIV_BUSY       6   // hpmcounter6: divider busy cycles
+#define PERF_GRAPHITE_BUSY  7   // hpmcounter7: cycles Graphite does not accept commands
+#define PERF_NB_COUNTERS    8
+
+#define PERF_CSR_READ(_csr_) ({ uint32_t _v_; asm volatile("csrr %0, " #_csr_ : "=r"(_v_)); _v_; })
+
+// Reads a 64-bit counter, retrying if its low half wrapped in between
+#define PERF_READ64(_lo_, _hi_) ({                      \
+    uint32_t _h_, _l_;                                  \
+    do {                                                \
+        _h_ = PERF_CSR_READ(_hi_);                      \
+        _l_ = PERF_CSR_READ(_lo_);                      \
+    } while (_h_ != PERF_CSR_READ(_hi_));               \
+    ((uint64_t)_h_ << 32) | _l_; })
+
+static inline uint64_t perf_cycles()        { return PERF_READ64(0xC00, 0xC80); }
+static inline uint64_t perf_instret()       { return PERF_READ64(0xC02, 0xC82); }
+static inline uint64_t perf_cache_misses()  { return PERF_READ64(0xC03, 0xC83); }
+static inline uint64_t perf_stall_cycles()  { return PERF_READ64(0xC04, 0xC84); }
+static inline uint64_t perf_fpu_busy()      { return PERF_READ64(0xC05, 0xC85); }
+static inline uint64_t perf_div_busy()      { return PERF_READ64(0xC06, 0xC86); }
+static inline uint64_t perf_graphite_busy() { return PERF_READ64(0xC07, 0xC87); }
+
+typedef struct {
+    uint64_t counters[PERF_NB_COUNTERS];    // indexed by PERF_x, 1 is unused
+} perf_snapshot_t;
+
+static inline void perf_snapshot(perf_snapshot_t *s)
+{
+    s->counters[PERF_CYCLES] = perf_cycles();
+    s->counters[1] = 0;
+    s->counters[PERF_INSTRET] = perf_instret();
+    s->counters[PERF_CACHE_MISS] = perf_cache_misses();
+    s->counters[PERF_STALL] = perf_stall_cycles();
+    s->counters[PERF_FPU_BUSY] = perf_fpu_busy();
+    s->counters[PERF_DIV_BUSY] = perf_div_busy();
+    s->counters[PERF_GRAPHITE_BUSY] = perf_graphite_busy();
+}
+
+// d = b - a
+static inline void perf_diff(perf_snapshot_t *d, const perf_snapshot_t *a, const perf_snapshot_t *b)
+{
+    for (int i = 0; i < PERF_NB_COUNTERS; ++i)
+        d->counters[i] = b->counters[i] - a->counters[i];
+}
+
+#endif
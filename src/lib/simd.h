@@ -0,0 +1,90 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <stdint.h>
+
+// Packed SIMD instructions of the processor (custom-0 opcode, see
+// rtl/riscv/processor.v): two 16-bit lanes per register, the low lane in
+// bits 15:0. The names and semantics are those of the RISC-V P extension.
+// The K prefix saturates to signed values, UK to unsigned ones.
+
+#define SIMD_INSN_R(_f3_, _f7_, _a_, _b_) ({                                                \
+    uint32_t _r_;                                                                           \
+    asm(".insn r 0x0b, " #_f3_ ", " #_f7_ ", %0, %1, %2" : "=r"(_r_) : "r"(_a_), "r"(_b_)); \
+    _r_; })
+
+// Immediate forms: the funct7 bits are the upper bits of the I-type immediate
+#define SIMD_INSN_I(_f3_, _f7_, _a_, _imm_) ({                                              \
+    uint32_t _r_;                                                                           \
+    asm(".insn i 0x0b, " #_f3_ ", %0, %1, %2" : "=r"(_r_)                                   \
+        : "r"(_a_), "i"(((((_f7_) << 5) | ((_imm_) & 15)) ^ 0x800) - 0x800));               \
+    _r_; })
+
+static inline uint32_t simd_pack(int16_t lo, int16_t hi)
+{
+    return (uint32_t)(uint16_t)hi << 16 | (uint16_t)lo;
+}
+
+static inline int16_t simd_lo(uint32_t v) { return (int16_t)v; }
+static inline int16_t simd_hi(uint32_t v) { return (int16_t)(v >> 16); }
+
+// Lane-wise arithmetic, wrapping around
+static inline uint32_t simd_add16(uint32_t a, uint32_t b) { return SIMD_INSN_R(0, 0x00, a, b); }
+static inline uint32_t simd_sub16(uint32_t a, uint32_t b) { return SIMD_INSN_R(0, 0x20, a, b); }
+
+// Lane-wise arithmetic, saturated
+static inline uint32_t simd_kadd16(uint32_t a, uint32_t b)  { return SIMD_INSN_R(1, 0x00, a, b); }
+static inline uint32_t simd_ksub16(uint32_t a, uint32_t b)  { return SIMD_INSN_R(1, 0x20, a, b); }
+static inline uint32_t simd_ukadd16(uint32_t a, uint32_t b) { return SIMD_INSN_R(2, 0x00, a, b); }
+static inline uint32_t simd_uksub16(uint32_t a, uint32_t b) { return SIMD_INSN_R(2, 0x20, a, b); }
+
+// Q15 multiplication (a * b >> 15), saturated
+static inline uint32_t simd_khm16(uint32_t a, uint32_t b) { return SIMD_INSN_R(3, 0x00, a, b); }
+
+// Low 16 bits of the products
+static inline uint32_t simd_mul16(uint32_t a, uint32_t b) { return SIMD_INSN_R(4, 0x00, a, b); }
+
+// acc + a.lo * b.lo + a.hi * b.hi, signed, saturated to 32 bits
+static inline int32_t simd_kmada(int32_t acc, uint32_t a, uint32_t b)
+{
+    int32_t r;
+    asm(".insn r4 0x0b, 5, 0, %0, %1, %2, %3" : "=r"(r) : "r"(a), "r"(b), "r"(acc));
+    return r;
+}
+
+// Clip to [-2^n, 2^n - 1] and [0, 2^n - 1], n in [0, 15]
+#define simd_sclip16(_a_, _n_) SIMD_INSN_I(6, 0x00, _a_, _n_)
+#define simd_uclip16(_a_, _n_) SIMD_INSN_I(6, 0x20, _a_, _n_)
+
+// Shifts by n in [0, 15]
+#define simd_srli16(_a_, _n_)  SIMD_INSN_I(7, 0x00, _a_, _n_)
+#define simd_srai16(_a_, _n_)  SIMD_INSN_I(7, 0x20, _a_, _n_)
+#define simd_slli16(_a_, _n_)  SIMD_INSN_I(7, 0x40, _a_, _n_)
+
+// Blends two pairs of RGB565 pixels: a + (b - a) * alpha / 32, alpha in
+// [0, 32], one channel of both pixels per operation
+static inline uint32_t simd_blend_rgb565(uint32_t a, uint32_t b, unsigned alpha)
+{
+    uint32_t k = alpha << 16 | alpha;
+
+    uint32_t ra = simd_srli16(a, 11), rb = simd_srli16(b, 11);
+    uint32_t ga = simd_srli16(a, 5) & 0x003F003F, gb = simd_srli16(b, 5) & 0x003F003F;
+    uint32_t ba = a & 0x001F001F, bb = b & 0x001F001F;
+
+    uint32_t r = simd_add16(ra, simd_srai16(simd_mul16(simd_sub16(rb, ra), k), 5));
+    uint32_t g = simd_add16(ga, simd_srai16(simd_mul16(simd_sub16(gb, ga), k), 5));
+    uint32_t bl = simd_add16(ba, simd_srai16(simd_mul16(simd_sub16(bb, ba), k), 5));
+
+    return simd_slli16(r, 11) | simd_slli16(g, 5) | bl;
+}
+
+// Dot product of two vectors of 2n Q15 values packed in pairs, in Q30
+static inline int32_t simd_dot_q15(const uint32_t *a, const uint32_t *b, int n)
+{
+    int32_t acc = 0;
+    for (int i = 0; i < n; ++i)
+        acc = simd_kmada(acc, a[i], b[i]);
+    return acc;
+}
+
+#endif
@@ -0,0 +1,129 @@
+#include <io.h>
+#include <stdlib.h>
+
+// Checks DIV, DIVU, REM and REMU against fixed results (division by zero,
+// overflow, dividend smaller than the divisor, signs) and against a bitwise
+// reference on operands of all magnitudes, for any DIV_BITS of the divider.
+
+#define OP(_op_, _a_, _b_) ({                                                   \
+    unsigned int _r_;                                                           \
+    asm(#_op_ " %0, %1, %2" : "=r"(_r_) : "r"(_a_), "r"(_b_));                  \
+    _r_; })
+
+#define NB_RANDOM 500
+
+struct div_case {
+    unsigned int a, b;
+    unsigned int div, divu, rem, remu;
+};
+
+static const struct div_case cases[] = {
+    {0x00000007, 0x00000000, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000007, 0x00000007},
+    {0x80000000, 0x00000000, 0xFFFFFFFF, 0xFFFFFFFF, 0x80000000, 0x80000000},
+    {0x00000000, 0x00000000, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0x00000000},
+    {0x80000000, 0xFFFFFFFF, 0x80000000, 0x00000000, 0x00000000, 0x80000000},
+    {0x00000003, 0x0000000A, 0x00000000, 0x00000000, 0x00000003, 0x00000003},
+    {0xFFFFFFFD, 0x0000000A, 0x00000000, 0x19999999, 0xFFFFFFFD, 0x00000003},
+    {0x00000064, 0x00000007, 0x0000000E, 0x0000000E, 0x00000002, 0x00000002},
+    {0xFFFFFF9C, 0x00000007, 0xFFFFFFF2, 0x24924916, 0xFFFFFFFE, 0x00000002},
+    {0x00000064, 0xFFFFFFF9, 0xFFFFFFF2, 0x00000000, 0x00000002, 0x00000064},
+    {0xFFFFFF9C, 0xFFFFFFF9, 0x0000000E, 0x00000000, 0xFFFFFFFE, 0xFFFFFF9C},
+    {0x00000000, 0x00000005, 0x00000000, 0x00000000, 0x00000000, 0x00000000},
+    {0x00000001, 0x00000001, 0x00000001, 0x00000001, 0x00000000, 0x00000000},
+    {0xFFFFFFFF, 0x00000001, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0x00000000},
+    {0xFFFFFFFF, 0xFFFFFFFF, 0x00000001, 0x00000001, 0x00000000, 0x00000000},
+    {0xFFFFFFFE, 0xFFFFFFFF, 0x00000002, 0x00000000, 0x00000000, 0xFFFFFFFE},
+    {0x7FFFFFFF, 0x00000002, 0x3FFFFFFF, 0x3FFFFFFF, 0x00000001, 0x00000001},
+    {0x80000000, 0x00000001, 0x80000000, 0x80000000, 0x00000000, 0x00000000},
+    {0xDEADBEEF, 0x00001234, 0xFFFE2B63, 0x000C3BA5, 0xFFFFF8D3, 0x0000076B},
+    {0x12345678, 0x9ABCDEF0, 0x00000000, 0x00000000, 0x12345678, 0x12345678},
+    {0x0000FFFF, 0x0000000A, 0x00001999, 0x00001999, 0x00000005, 0x00000005},
+    {0x7FFFFFFF, 0x7FFFFFFF, 0x00000001, 0x00000001, 0x00000000, 0x00000000},
+};
+
+static int failures = 0;
+
+static void check(const char *op, unsigned int a, unsigned int b, unsigned int result, unsigned int expected)
+{
+    if (result == expected)
+        return;
+
+    char s[16];
+    print(op);
+    print(" 0x");
+    print(uitoa(a, s, 16));
+    print(", 0x");
+    print(uitoa(b, s, 16));
+    print(": 0x");
+    print(uitoa(result, s, 16));
+    print(", expected 0x");
+    print(uitoa(expected, s, 16));
+    print("\r\n");
+    failures++;
+}
+
+// Restoring division, one quotient bit at a time (b != 0)
+static void ref_divu(unsigned int a, unsigned int b, unsigned int *q, unsigned int *r)
+{
+    unsigned int rem = 0, quo = 0;
+    for (int i = 31; i >= 0; --i) {
+        unsigned int carry = rem >> 31;
+        rem = rem << 1 | ((a >> i) & 1);
+        quo <<= 1;
+        if (carry || rem >= b) {
+            rem -= b;
+            quo |= 1;
+        }
+    }
+    *q = quo;
+    *r = rem;
+}
+
+static void check_random(unsigned int a, unsigned int b)
+{
+    unsigned int q, r;
+    ref_divu(a, b, &q, &r);
+    check("divu", a, b, OP(divu, a, b), q);
+    check("remu", a, b, OP(remu, a, b), r);
+
+    // Signed results from the magnitudes (no overflow: b is not -1 here)
+    int neg_a = (int)a < 0, neg_b = (int)b < 0;
+    ref_divu(neg_a ? -a : a, neg_b ? -b : b, &q, &r);
+    check("div", a, b, OP(div, a, b), neg_a != neg_b ? -q : q);
+    check("rem", a, b, OP(rem, a, b), neg_a ? -r : r);
+}
+
+void main(void)
+{
+    MEM_WRITE(LED, 0x01);
+
+    for (unsigned int i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        const struct div_case *c = &cases[i];
+        check("div", c->a, c->b, OP(div, c->a, c->b), c->div);
+        check("divu", c->a, c->b, OP(divu, c->a, c->b), c->divu);
+        check("rem", c->a, c->b, OP(rem, c->a, c->b), c->rem);
+        check("remu", c->a, c->b, OP(remu, c->a, c->b), c->remu);
+    }
+
+    // Operands of random magnitudes, for the early termination of the divider
+    srand(1);
+    for (int i = 0; i < NB_RANDOM; ++i) {
+        unsigned int a = ((unsigned int)rand() << 16 ^ (unsigned int)rand()) >> (rand() % 32);
+        unsigned int b = ((unsigned int)rand() << 16 ^ (unsigned int)rand()) >> (rand() % 32);
+        if (rand() & 1)
+            a = -a;
+        if (rand() & 1)
+            b = -b;
+        if (b == 0 || b == 0xFFFFFFFF)
+            continue;
+        check_random(a, b);
+    }
+
+    if (failures) {
+        print("DIV/REM: failed\r\n");
+        MEM_WRITE(LED, 0xFF);
+    } else {
+        print("DIV/REM: all checks passed\r\n");
+        MEM_WRITE(LED, 0x00);
+    }
+}
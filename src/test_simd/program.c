@@ -0,0 +1,166 @@
+#include <io.h>
+#include <simd.h>
+#include <stdlib.h>
+
+// Checks the packed SIMD intrinsics of simd.h against C references, on the
+// saturation edges of each lane and on random lanes.
+
+#define NB_RANDOM 200
+
+static const int16_t edges[] = {
+    0, 1, -1, 2, -2, 0x7FFF, -0x8000, 0x7FFE, -0x7FFF, 0x4000, -0x4000, 0x00FF, 0x1234, -0x1234,
+};
+
+#define NB_EDGES (sizeof(edges) / sizeof(edges[0]))
+
+static const int32_t accs[] = {0, 1, -1, 0x7FFFFFFF, -0x7FFFFFFF - 1, 0x3FFF0001, -0x40000000};
+
+#define NB_ACCS (sizeof(accs) / sizeof(accs[0]))
+
+static int failures = 0;
+
+static void check(const char *op, uint32_t a, uint32_t b, uint32_t result, uint32_t expected)
+{
+    if (result == expected)
+        return;
+
+    char s[16];
+    print(op);
+    print(" 0x");
+    print(uitoa(a, s, 16));
+    print(", 0x");
+    print(uitoa(b, s, 16));
+    print(": 0x");
+    print(uitoa(result, s, 16));
+    print(", expected 0x");
+    print(uitoa(expected, s, 16));
+    print("\r\n");
+    failures++;
+}
+
+static int32_t clamp(int32_t v, int32_t min, int32_t max)
+{
+    return v < min ? min : v > max ? max : v;
+}
+
+// Lane operations of the references, on the lanes as signed or unsigned values
+enum lane_op { ADD, SUB, KADD, KSUB, UKADD, UKSUB, KHM, MUL, SCLIP, UCLIP, SRLI, SRAI, SLLI };
+
+static uint16_t ref_lane(enum lane_op op, uint16_t a, uint16_t b, int n)
+{
+    int32_t sa = (int16_t)a, sb = (int16_t)b;
+    switch (op) {
+    case ADD:   return a + b;
+    case SUB:   return a - b;
+    case KADD:  return clamp(sa + sb, -0x8000, 0x7FFF);
+    case KSUB:  return clamp(sa - sb, -0x8000, 0x7FFF);
+    case UKADD: return clamp((int32_t)a + b, 0, 0xFFFF);
+    case UKSUB: return clamp((int32_t)a - b, 0, 0xFFFF);
+    case KHM:   return clamp(sa * sb >> 15, -0x8000, 0x7FFF);
+    case MUL:   return (uint32_t)(sa * sb);
+    case SCLIP: return clamp(sa, -(1 << n), (1 << n) - 1);
+    case UCLIP: return clamp(sa, 0, (1 << n) - 1);
+    case SRLI:  return a >> n;
+    case SRAI:  return sa >> n;
+    default:    return a << n;
+    }
+}
+
+static uint32_t ref(enum lane_op op, uint32_t a, uint32_t b, int n)
+{
+    return (uint32_t)ref_lane(op, a >> 16, b >> 16, n) << 16 | ref_lane(op, a, b, n);
+}
+
+static int32_t ref_kmada(int32_t acc, uint32_t a, uint32_t b)
+{
+    int64_t r = (int64_t)acc + (int16_t)a * (int16_t)b + (int16_t)(a >> 16) * (int16_t)(b >> 16);
+    return r > 0x7FFFFFFF ? 0x7FFFFFFF : r < -0x7FFFFFFF - 1 ? -0x7FFFFFFF - 1 : (int32_t)r;
+}
+
+static uint16_t ref_blend_pixel(uint16_t a, uint16_t b, unsigned alpha)
+{
+    int ra = a >> 11, ga = a >> 5 & 0x3F, ba = a & 0x1F;
+    int rb = b >> 11, gb = b >> 5 & 0x3F, bb = b & 0x1F;
+    int r = ra + ((rb - ra) * (int)alpha >> 5);
+    int g = ga + ((gb - ga) * (int)alpha >> 5);
+    int bl = ba + ((bb - ba) * (int)alpha >> 5);
+    return r << 11 | g << 5 | bl;
+}
+
+// The immediate forms need a constant shift or clip amount
+#define CHECK_IMM(_n_) do {                                                                 \
+        check("sclip16 " #_n_, a, 0, simd_sclip16(a, _n_), ref(SCLIP, a, 0, _n_));          \
+        check("uclip16 " #_n_, a, 0, simd_uclip16(a, _n_), ref(UCLIP, a, 0, _n_));          \
+        check("srli16 " #_n_, a, 0, simd_srli16(a, _n_), ref(SRLI, a, 0, _n_));             \
+        check("srai16 " #_n_, a, 0, simd_srai16(a, _n_), ref(SRAI, a, 0, _n_));             \
+        check("slli16 " #_n_, a, 0, simd_slli16(a, _n_), ref(SLLI, a, 0, _n_));             \
+    } while (0)
+
+static void check_pair(uint32_t a, uint32_t b)
+{
+    check("add16", a, b, simd_add16(a, b), ref(ADD, a, b, 0));
+    check("sub16", a, b, simd_sub16(a, b), ref(SUB, a, b, 0));
+    check("kadd16", a, b, simd_kadd16(a, b), ref(KADD, a, b, 0));
+    check("ksub16", a, b, simd_ksub16(a, b), ref(KSUB, a, b, 0));
+    check("ukadd16", a, b, simd_ukadd16(a, b), ref(UKADD, a, b, 0));
+    check("uksub16", a, b, simd_uksub16(a, b), ref(UKSUB, a, b, 0));
+    check("khm16", a, b, simd_khm16(a, b), ref(KHM, a, b, 0));
+    check("mul16", a, b, simd_mul16(a, b), ref(MUL, a, b, 0));
+    for (unsigned int i = 0; i < NB_ACCS; ++i)
+        check("kmada", a, b, simd_kmada(accs[i], a, b), ref_kmada(accs[i], a, b));
+
+    CHECK_IMM(0);
+    CHECK_IMM(1);
+    CHECK_IMM(7);
+    CHECK_IMM(8);
+    CHECK_IMM(14);
+    CHECK_IMM(15);
+}
+
+static uint32_t rand32(void)
+{
+    return (uint32_t)rand() << 16 ^ (uint32_t)rand();
+}
+
+void main(void)
+{
+    MEM_WRITE(LED, 0x01);
+
+    // Every pair of edge values in both lanes
+    for (unsigned int i = 0; i < NB_EDGES; ++i)
+        for (unsigned int j = 0; j < NB_EDGES; ++j)
+            check_pair(simd_pack(edges[i], edges[j]), simd_pack(edges[j], edges[i]));
+
+    srand(1);
+    for (int i = 0; i < NB_RANDOM; ++i)
+        check_pair(rand32(), rand32());
+
+    // Blending of RGB565 pixel pairs, alpha from 0 to 32
+    for (int i = 0; i < NB_RANDOM; ++i) {
+        uint32_t a = rand32(), b = rand32();
+        unsigned alpha = i % 33;
+        uint32_t expected = (uint32_t)ref_blend_pixel(a >> 16, b >> 16, alpha) << 16 | ref_blend_pixel(a, b, alpha);
+        check("blend_rgb565", a, b, simd_blend_rgb565(a, b, alpha), expected);
+    }
+
+    // Q15 dot product, saturating on the full-scale vectors
+    uint32_t va[8], vb[8];
+    int32_t expected = 0;
+    for (int i = 0; i < 8; ++i) {
+        va[i] = rand32();
+        vb[i] = rand32();
+        expected = ref_kmada(expected, va[i], vb[i]);
+    }
+    check("dot_q15", va[0], vb[0], simd_dot_q15(va, vb, 8), expected);
+    for (int i = 0; i < 8; ++i)
+        va[i] = vb[i] = simd_pack(-0x8000, -0x8000);
+    check("dot_q15", va[0], vb[0], simd_dot_q15(va, vb, 8), 0x7FFFFFFF);
+
+    if (failures) {
+        print("SIMD: failed\r\n");
+        MEM_WRITE(LED, 0xFF);
+    } else {
+        print("SIMD: all checks passed\r\n");
+        MEM_WRITE(LED, 0x00);
+    }
+}
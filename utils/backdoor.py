@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+#
+# Client of the simulator memory backdoor (--backdoor <socket>), see
+# rtl/sim/sim_backdoor.h for the protocol. Command line use:
+#
+#   backdoor.py <socket> read <addr> <len> <file>
+#   backdoor.py <socket> write <addr> <file>
+#   backdoor.py <socket> wait <addr> [len]      wait for a store, paused, and
+#                                               print the stored word
+
+import socket
+import struct
+import sys
+
+MSG = struct.Struct("=IIII")
+EVENT = struct.Struct("=IQ")
+
+class BackdoorError(Exception):
+    pass
+
+class Backdoor:
+    def __init__(self, path):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self.sock.connect(path)
+        self.events = []
+
+    def close(self):
+        self.sock.close()
+
+    def _recv(self, n):
+        data = bytearray()
+        while len(data) < n:
+            chunk = self.sock.recv(min(n - len(data), 1 << 20))
+            if not chunk:
+                raise BackdoorError("connection closed")
+            data += chunk
+        return bytes(data)
+
+    def _msg(self):
+        cmd, addr, length, arg = MSG.unpack(self._recv(MSG.size))
+        return chr(cmd), addr, length, arg
+
+    def _event(self, addr, length, arg):
+        data, cycle = EVENT.unpack(self._recv(length))
+        return {"addr": addr, "wmask": arg, "data": data, "cycle": cycle}
+
+    def _request(self, cmd, addr=0, length=0, arg=0, data=b""):
+        self.sock.sendall(MSG.pack(ord(cmd), addr, length, arg) + data)
+        while True:
+            reply, r_addr, r_len, r_arg = self._msg()
+            if reply == "E":
+                self.events.append(self._event(r_addr, r_len, r_arg))
+            elif reply == "X":
+                raise BackdoorError("%s 0x%x %d rejected" % (cmd, addr, length))
+            else:
+                return r_addr, r_len, r_arg
+
+    def read(self, addr, length):
+        self._request("R", addr, length)
+        return self._recv(length)
+
+    def write(self, addr, data):
+        self._request("W", addr, len(data), 0, bytes(data))
+
+    def watch(self, addr, length=4, stop=True):
+        self._request("A", addr, length, 1 if stop else 0)
+
+    def unwatch(self, addr, length=4):
+        self._request("D", addr, length)
+
+    def resume(self):
+        self._request("C")
+
+    def status(self):
+        _, length, paused = self._request("S")
+        cycles, = struct.unpack("=Q", self._recv(length))
+        return bool(paused), cycles
+
+    def wait_event(self):
+        if self.events:
+            return self.events.pop(0)
+        while True:
+            reply, addr, length, arg = self._msg()
+            if reply == "E":
+                return self._event(addr, length, arg)
+
+def main(argv):
+    if len(argv) < 3:
+        print("Usage: backdoor.py <socket> read <addr> <len> <file> | write <addr> <file> | wait <addr> [len]")
+        exit(0)
+
+    bd = Backdoor(argv[0])
+    if argv[1] == "read":
+        with open(argv[4], "wb") as f:
+            f.write(bd.read(int(argv[2], 0), int(argv[3], 0)))
+    elif argv[1] == "write":
+        with open(argv[3], "rb") as f:
+            bd.write(int(argv[2], 0), f.read())
+    elif argv[1] == "wait":
+        bd.watch(int(argv[2], 0), int(argv[3], 0) if len(argv) >= 4 else 4)
+        e = bd.wait_event()
+        print("0x%08x: 0x%08x (mask 0x%x) at cycle %d" % (e["addr"], e["data"], e["wmask"], e["cycle"]))
+    bd.close()
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
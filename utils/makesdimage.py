@@ -0,0 +1,29 @@
+#!/usr/bin/env python3
+#
+# Build an SD card image booted by the firmware: block 0 holds the image info
+# (sd_image_info_t: "XG" and the program length), the program starts at block 1.
+
+import struct
+import sys
+
+BLOCK_LEN = 512
+
+def main(argv):
+    if len(argv) < 2:
+        print("Usage: makesdimage.py <program binary> <image file> [image size in MiB]")
+        exit(0)
+
+    size = int(argv[2]) * 1024 * 1024 if len(argv) >= 3 else 0
+
+    with open(argv[0], "rb") as f:
+        program = f.read()
+
+    info = struct.pack("<2sxxI", b"XG", len(program))
+    image = info.ljust(BLOCK_LEN, b"\0") + program
+    image = image.ljust(max(size, (len(image) + BLOCK_LEN - 1) // BLOCK_LEN * BLOCK_LEN), b"\0")
+
+    with open(argv[1], "wb") as f:
+        f.write(image)
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
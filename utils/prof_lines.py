@@ -0,0 +1,37 @@
+#!/usr/bin/env python3
+#
+# Per-line histogram from a simulator profile (<prefix>.pcs), resolved with
+# addr2line against the profiled ELF file.
+
+import subprocess
+import sys
+
+def main(argv):
+    if len(argv) < 2:
+        print("Usage: prof_lines.py <pcs file> <elf file> [addr2line] [number of lines]")
+        exit(0)
+
+    addr2line = argv[2] if len(argv) >= 3 else "riscv-none-elf-addr2line"
+    nb_lines = int(argv[3]) if len(argv) >= 4 else 50
+
+    addrs = []
+    counts = []
+    with open(argv[0], 'r') as file:
+        for line in file:
+            fields = line.split()
+            addrs.append(fields[0])
+            counts.append(int(fields[1]))
+
+    out = subprocess.run([addr2line, "-e", argv[1]] + addrs, capture_output=True, text=True, check=True)
+
+    lines = {}
+    for location, count in zip(out.stdout.splitlines(), counts):
+        location = location.split(" (discriminator")[0]
+        lines[location] = lines.get(location, 0) + count
+
+    total = max(sum(counts), 1)
+    for location, count in sorted(lines.items(), key=lambda x: -x[1])[:nb_lines]:
+        print("%12d %6.2f%% %s" % (count, 100.0 * count / total, location))
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
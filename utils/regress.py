@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+#
+# Run the test cases of a manifest on the headless simulator, in parallel,
+# each in its own working directory, and write a JUnit report.
+#
+# Manifest (JSON, paths relative to the manifest):
+#
+# {
+#   "tests": [
+#     {
+#       "name": "factorial",
+#       "program": "../../src/factorial/program.elf",
+#       "max_cycles": 10000000,
+#       "exit_led": "0x04",                 optional LED sentinel
+#       "uart": "The factorial of 5 is 120", optional expected UART output
+#       "frames": {"10": "0123456789abcdef"}, optional frame hashes (null: any)
+#       "args": ["--sd-image", "sd.img"],   optional simulator arguments
+#       "timeout": 600                      optional wall-clock limit (s)
+#     }
+#   ]
+# }
+#
+# A case passes if the simulator exits with status 0 (the LED sentinel is
+# written within the cycle budget, if any), its output contains the
+# expected UART text and the captured frames have the expected hashes.
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import threading
+import time
+import xml.etree.ElementTree as ET
+from concurrent.futures import ThreadPoolExecutor
+
+SIM_DIR = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "rtl", "sim"))
+
+# Files read by the model from its working directory ($readmemh)
+SIM_FILES = ["firmware.hex", "vdu_palette.hex"]
+
+DEFAULT_TIMEOUT = 3600
+
+def run_test(test, args, base_dir, print_lock):
+    name = test["name"]
+    work_dir = os.path.join(args.output, name)
+    os.makedirs(work_dir, exist_ok=True)
+    for f in SIM_FILES:
+        link = os.path.join(work_dir, f)
+        if os.path.lexists(link):
+            os.remove(link)
+        os.symlink(os.path.join(SIM_DIR, f), link)
+
+    cmd = [args.simulator, "--program", os.path.normpath(os.path.join(base_dir, test["program"])), "--uart", "stdio"]
+    if "max_cycles" in test:
+        cmd += ["--max-cycles", str(test["max_cycles"])]
+    if "exit_led" in test:
+        cmd += ["--exit-led", str(test["exit_led"])]
+    frames = test.get("frames", {})
+    if frames:
+        cmd += ["--fb-frames", ",".join(sorted(frames, key=int))]
+    cmd += test.get("args", [])
+
+    result = {"name": name, "failures": [], "cycles": 0, "output": ""}
+    start = time.time()
+    try:
+        out = subprocess.run(cmd, cwd=work_dir, stdin=subprocess.DEVNULL, stdout=subprocess.PIPE,
+                             stderr=subprocess.STDOUT, timeout=test.get("timeout", DEFAULT_TIMEOUT))
+        output = out.stdout.decode("utf-8", "replace")
+        if out.returncode != 0:
+            result["failures"].append("exit status %d" % out.returncode)
+    except subprocess.TimeoutExpired as e:
+        output = (e.stdout or b"").decode("utf-8", "replace")
+        result["failures"].append("timeout")
+    except OSError as e:
+        output = ""
+        result["failures"].append(str(e))
+    result["time"] = time.time() - start
+    result["output"] = output
+
+    with open(os.path.join(work_dir, "output.log"), "w") as f:
+        f.write(output)
+
+    m = re.search(r"cycles: (\d+)", output)
+    if m:
+        result["cycles"] = int(m.group(1))
+
+    if "uart" in test and test["uart"] not in output.replace("\r", ""):
+        result["failures"].append("expected UART output not found: %r" % test["uart"])
+
+    hashes = dict(re.findall(r"^Frame (\d+): cycle \d+, render \d+ cycles, hash ([0-9a-f]+)", output, re.M))
+    for frame, expected in frames.items():
+        actual = hashes.get(str(int(frame)))
+        if actual is None:
+            result["failures"].append("frame %s not captured" % frame)
+        elif expected is not None and actual != expected.lower():
+            result["failures"].append("frame %s: hash %s, expected %s" % (frame, actual, expected))
+
+    with print_lock:
+        print("%-24s %s  %12d cycles  %8.1f s%s" % (name, "FAIL" if result["failures"] else "pass",
+              result["cycles"], result["time"],
+              "".join("\n    " + f for f in result["failures"])))
+        sys.stdout.flush()
+
+    return result
+
+def write_junit(path, suite_name, results, elapsed):
+    failures = sum(1 for r in results if r["failures"])
+    suite = ET.Element("testsuite", name=suite_name, tests=str(len(results)),
+                       failures=str(failures), errors="0", time="%.3f" % elapsed)
+    for r in results:
+        case = ET.SubElement(suite, "testcase", classname=suite_name, name=r["name"], time="%.3f" % r["time"])
+        props = ET.SubElement(case, "properties")
+        ET.SubElement(props, "property", name="cycles", value=str(r["cycles"]))
+        ET.SubElement(props, "property", name="mhz",
+                      value="%.3f" % (r["cycles"] / r["time"] / 1e6 if r["time"] > 0 else 0.0))
+        if r["failures"]:
+            failure = ET.SubElement(case, "failure", message="; ".join(r["failures"]))
+            failure.text = "\n".join(r["failures"])
+        ET.SubElement(case, "system-out").text = r["output"][-4096:]
+    ET.ElementTree(suite).write(path, encoding="utf-8", xml_declaration=True)
+
+def main(argv):
+    parser = argparse.ArgumentParser(description="Run a test manifest on the headless simulator")
+    parser.add_argument("manifest")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count(), help="parallel simulations")
+    parser.add_argument("-s", "--simulator", default=os.path.join(SIM_DIR, "obj_dir_headless", "Vtop"))
+    parser.add_argument("-o", "--output", default="regress", help="working directories")
+    parser.add_argument("-r", "--report", default="regress.xml", help="JUnit report")
+    parser.add_argument("-k", "--filter", default="", help="only run the tests whose name matches")
+    args = parser.parse_args(argv)
+
+    args.simulator = os.path.abspath(args.simulator)
+    args.output = os.path.abspath(args.output)
+
+    with open(args.manifest, "r") as f:
+        manifest = json.load(f)
+    base_dir = os.path.dirname(os.path.abspath(args.manifest))
+    tests = [t for t in manifest["tests"] if re.search(args.filter, t["name"])]
+
+    start = time.time()
+    print_lock = threading.Lock()
+    with ThreadPoolExecutor(max_workers=max(args.jobs, 1)) as pool:
+        results = list(pool.map(lambda t: run_test(t, args, base_dir, print_lock), tests))
+    elapsed = time.time() - start
+
+    suite_name = os.path.splitext(os.path.basename(args.manifest))[0]
+    write_junit(args.report, suite_name, results, elapsed)
+
+    failures = sum(1 for r in results if r["failures"])
+    print("%d tests, %d failures, %.1f s" % (len(results), failures, elapsed))
+    exit(1 if failures else 0)
+
+if __name__ == "__main__":
+    main(sys.argv[1:])